@@ -0,0 +1,213 @@
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+
+#include <tokenizer/InputStream.h>
+#include <tokenizer/Tokenizer.h>
+#include <transpiler/transpiler.h>
+#include <context/CompilationContext.h>
+#include <parser/parser.h>
+
+/* Shape of the generated corpus, every knob can be set from the command line. */
+struct CorpusOptions {
+    std::size_t size_kb     = 4096; // approximate size of the corpus
+    unsigned    nesting     = 4;    // depth of the if/while blocks inside functions
+    unsigned    string_len  = 120;  // length of the long string literals
+    uint32_t    seed        = 42;
+};
+
+/**
+ * @brief Generates a synthetic program mixing what the front end has to handle: many functions,
+ * nested blocks, long strings, f-strings, templates, typedefs and top-level statements.
+ */
+std::string generateCorpus(const CorpusOptions& _opts) {
+    std::mt19937 rng(_opts.seed);
+    std::string src;
+    src.reserve(_opts.size_kb * 1024 + 4096);
+
+    auto long_string = [&](char _quote) {
+        std::string str(1, _quote);
+        for (unsigned i = 0; i < _opts.string_len; i++)
+            str += static_cast<char>('a' + rng() % 26);
+        return str + _quote;
+    };
+
+    src += "importc \"cmath\"\ntypedef ll long long\n#define LIMIT 100\n";
+
+    for (std::size_t fn = 0; src.size() < _opts.size_kb * 1024; fn++) {
+        std::string id = std::to_string(fn);
+
+        switch (fn % 4) {
+            case 0: // function with nested blocks
+                src += "func fn_" + id + "(int a, int b): int {\n";
+                src += "    int x_" + id + " = a + b * " + std::to_string(rng() % 1000) + ".5\n";
+                for (unsigned depth = 0; depth < _opts.nesting; depth++) {
+                    std::string indent((depth + 1) * 4, ' ');
+                    src += indent + (depth % 2 ? "while x_" : "if x_") + id + " > " + std::to_string(depth) + " {\n";
+                    src += indent + "    x_" + id + "++\n";
+                }
+                for (unsigned depth = _opts.nesting; depth > 0; depth--)
+                    src += std::string(depth * 4, ' ') + "}\n";
+                src += "    return x_" + id + "\n}\n";
+                break;
+            case 1: // strings and f-strings
+                src += "func str_" + id + "(string s) {\n";
+                src += "    string l_" + id + " = " + long_string('"') + "\n";
+                src += "    string q_" + id + " = " + long_string('\'') + "\n";
+                src += "    print(f\"{s} and {l_" + id + "} escaped \\\" quote\")\n}\n";
+                break;
+            case 2: // template function
+                src += "func tmpl_" + id + "<T>(T v, int n) {\n";
+                src += "    for i in range(n) {\n        print(v, \" \", i)\n    }\n}\n";
+                break;
+            default: // top-level code
+                src += "var g_" + id + " = fn_" + std::to_string(fn - 3) + "(" + id + ", LIMIT)\n";
+                src += "if g_" + id + " > 10 {\n    str_" + std::to_string(fn - 2) + "(\"g_" + id + "\")\n}";
+                src += " elif g_" + id + " == 2 {\n    tmpl_" + std::to_string(fn - 1) + "(g_" + id + ", 3)\n}\n";
+                src += "// comment after statement " + id + "\n";
+                break;
+        }
+    }
+
+    return src;
+}
+
+struct Result {
+    std::string name;
+    std::vector<double> seconds;
+};
+
+/** @brief runs `_setup` (untimed) then `_body` (timed) `_repeat` times */
+Result measure(const std::string& _name, unsigned _repeat, const std::function<void()>& _setup,
+               const std::function<void()>& _body) {
+    Result res{_name, {}};
+    for (unsigned i = 0; i < _repeat; i++) {
+        _setup();
+        auto start = std::chrono::steady_clock::now();
+        _body();
+        res.seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return res;
+}
+
+const char* USAGE = R"(Usage: swirl_bench [flags]
+
+Measures the throughput of each stage of the front end on a generated corpus.
+
+Flags:
+    --size <KiB>        size of the generated corpus (default 4096)
+    --nesting <depth>   nesting of blocks inside functions (default 4)
+    --string-len <n>    length of long string literals (default 120)
+    --seed <n>          seed of the generator (default 42)
+    --repeat <n>        runs per stage, the best and median are reported (default 5)
+    --input <file>      benchmark an existing .sw file instead of a generated corpus
+    --dump <file>       write the generated corpus to <file> and exit
+)";
+
+int main(int argc, const char** argv) {
+    CorpusOptions opts;
+    unsigned repeat = 5;
+    std::string input, dump;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "-h" || arg == "--help") { std::cout << USAGE; return 0; }
+        if (i + 1 == argc) { std::cerr << "Value missing for the flag: " << arg << '\n'; return 1; }
+
+        const char* val = argv[++i];
+        if (arg == "--size") opts.size_kb = std::stoul(val);
+        else if (arg == "--nesting") opts.nesting = std::stoul(val);
+        else if (arg == "--string-len") opts.string_len = std::stoul(val);
+        else if (arg == "--seed") opts.seed = std::stoul(val);
+        else if (arg == "--repeat") repeat = std::max(1ul, std::stoul(val));
+        else if (arg == "--input") input = val;
+        else if (arg == "--dump") dump = val;
+        else { std::cerr << "Unknown flag: " << arg << '\n'; return 1; }
+    }
+
+    std::string source;
+    if (!input.empty()) {
+        std::ifstream src_buf(input, std::ios::binary);
+        if (!src_buf) { std::cerr << "File '" << input << "' not found!\n"; return 1; }
+        source.assign(std::istreambuf_iterator<char>(src_buf), {});
+    } else source = generateCorpus(opts);
+
+    // the tokenizer expects the source to end in a newline, as SourceFile guarantees
+    if (source.empty() || source.back() != '\n') source += '\n';
+
+    if (!dump.empty()) {
+        std::ofstream(dump, std::ios::binary) << source;
+        return 0;
+    }
+
+    std::string build_file = (std::filesystem::temp_directory_path() / "swirl_bench.cpp").string();
+
+    std::size_t chars = 0, tokens = 0;
+    std::vector<Result> results;
+
+    results.push_back(measure("InputStream", repeat, [] {}, [&] {
+        InputStream is(source);
+        chars = 0;
+        while (!is.eof()) { is.next(); chars++; }
+    }));
+
+    results.push_back(measure("TokenStream", repeat, [] {}, [&] {
+        CompilationContext ctx(source);
+        InputStream is(source);
+        TokenStream tk(is, ctx.symbols);
+        tokens = 0;
+        while (tk.next(true, true).type != NONE) tokens++;
+    }));
+
+    results.push_back(measure("Parser::dispatch", repeat, [] {}, [&] {
+        CompilationContext ctx(source);
+        InputStream is(source);
+        TokenStream tk(is, ctx.symbols);
+        Parser parser(tk, ctx);
+        parser.dispatch();
+    }));
+
+    // transpile a fresh tree each run, the parse is not part of the timing
+    std::unique_ptr<CompilationContext> ctx;
+    std::unique_ptr<Parser> parser;
+    std::unique_ptr<InputStream> is;
+    std::unique_ptr<TokenStream> tk;
+    auto parse = [&] {
+        parser.reset();
+        ctx = std::make_unique<CompilationContext>(source);
+        is = std::make_unique<InputStream>(source);
+        tk = std::make_unique<TokenStream>(*is, ctx->symbols);
+        parser = std::make_unique<Parser>(*tk, *ctx);
+        parser->dispatch();
+    };
+    // no build file, so nothing is spilled and the stage doesn't touch the disk
+    auto transpile = [&] { Transpile(*ctx, *parser->m_AST, parser->m_AST->chl, "", ctx->output.main); };
+
+    results.push_back(measure("Transpile", repeat, parse, transpile));
+    results.push_back(measure("Output write", repeat, [&] { parse(); transpile(); }, [&] {
+        ctx->output.write(build_file);
+    }));
+    std::filesystem::remove(build_file);
+
+    double mb = source.size() / 1e6;
+    std::printf("corpus: %.2f MB, %zu chars, %zu tokens, %zu AST nodes, %u runs per stage\n\n",
+                mb, chars, tokens, parser->m_AST->nodeCount(), repeat);
+    std::printf("%-18s %12s %12s %12s\n", "stage", "best (ms)", "median (ms)", "best MB/s");
+
+    for (Result& res : results) {
+        std::sort(res.seconds.begin(), res.seconds.end());
+        double best = res.seconds.front(), median = res.seconds[res.seconds.size() / 2];
+        std::printf("%-18s %12.2f %12.2f %12.1f\n", res.name.c_str(), best * 1e3, median * 1e3, mb / best);
+    }
+
+    std::printf("\nParser::dispatch pulls its tokens from TokenStream, so it includes lexing.\n");
+    std::printf("Transpile keeps the output in memory, Output write is the time to write it to disk.\n");
+}
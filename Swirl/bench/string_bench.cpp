@@ -0,0 +1,132 @@
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+#include <swirl.string/String.h>
+
+/**
+ * @brief Generates log-like text: lines of random lowercase words, with `_needle` planted every
+ * `_every` lines so that searches have something to find.
+ */
+std::string generateText(std::size_t _size, std::string_view _needle, unsigned _every, uint32_t _seed) {
+    std::mt19937 rng(_seed);
+    std::string text;
+    text.reserve(_size + 256);
+
+    for (unsigned line = 0; text.size() < _size; line++) {
+        for (unsigned word = 0; word < 10; word++) {
+            for (unsigned len = 3 + rng() % 7; len; len--)
+                text += static_cast<char>('a' + rng() % 26);
+            text += ' ';
+        }
+        if (_every && line % _every == 0) text += _needle;
+        text += '\n';
+    }
+    return text;
+}
+
+/** @brief the best of `_repeat` runs of `_body`, in seconds */
+double best(unsigned _repeat, const std::function<void()>& _body) {
+    double ret = 1e9;
+    for (unsigned i = 0; i < _repeat; i++) {
+        auto start = std::chrono::steady_clock::now();
+        _body();
+        ret = std::min(ret, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return ret;
+}
+
+// keeps the optimizer from dropping the measured work
+volatile std::size_t sink;
+
+const char* USAGE = R"(Usage: swirl_string_bench [flags]
+
+Compares the Swirl_String search, split and replaceAll kernels with the libc routines
+(strstr, strtok) and the find/replace loop they replace.
+
+Flags:
+    --size <KiB>        size of the generated text (default 16384)
+    --every <n>         plant the needle every n lines (default 64)
+    --needle <str>      the string searched for and replaced (default "ERROR:")
+    --repeat <n>        runs per kernel, the best is reported (default 5)
+)";
+
+int main(int argc, const char** argv) {
+    std::size_t size_kb = 16384;
+    unsigned every = 64, repeat = 5;
+    std::string needle = "ERROR:";
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "-h" || arg == "--help") { std::cout << USAGE; return 0; }
+        if (i + 1 == argc) { std::cerr << "Value missing for the flag: " << arg << '\n'; return 1; }
+
+        const char* val = argv[++i];
+        if (arg == "--size") size_kb = std::stoul(val);
+        else if (arg == "--every") every = std::stoul(val);
+        else if (arg == "--needle") needle = val;
+        else if (arg == "--repeat") repeat = std::max(1ul, std::stoul(val));
+        else { std::cerr << "Unknown flag: " << arg << '\n' << USAGE; return 1; }
+    }
+
+    std::string text = generateText(size_kb * 1024, needle, every, 42);
+    Swirl_String str(text);
+    double mb = text.size() / 1e6;
+
+    std::printf("text: %.2f MB, needle \"%s\" every %u lines, best of %u\n\n", mb, needle.c_str(), every, repeat);
+    std::printf("%-34s %12s %12s\n", "kernel", "time (ms)", "MB/s");
+    auto report = [mb](const char* _name, double _secs) {
+        std::printf("%-34s %12.2f %12.1f\n", _name, _secs * 1e3, mb / _secs);
+    };
+
+    // count every occurrence, one search per hit
+    report("count (strstr)", best(repeat, [&] {
+        std::size_t count = 0;
+        for (const char* pos = text.c_str(); (pos = std::strstr(pos, needle.c_str())); pos += needle.size())
+            count++;
+        sink = count;
+    }));
+    report("count (string_view::find)", best(repeat, [&] {
+        std::size_t count = 0;
+        std::string_view view = text;
+        for (std::size_t pos = 0; (pos = view.find(needle, pos)) != view.npos; pos += needle.size())
+            count++;
+        sink = count;
+    }));
+    report("count (Swirl::search)", best(repeat, [&] {
+        std::size_t count = 0;
+        for (std::size_t pos = 0; (pos = Swirl::search(str, needle, pos)) != Swirl::npos; pos += needle.size())
+            count++;
+        sink = count;
+    }));
+
+    // strtok needs a copy it can write into, which is part of its cost
+    report("split lines (strtok)", best(repeat, [&] {
+        std::string copy = text;
+        std::vector<const char*> lines;
+        for (char* tok = std::strtok(copy.data(), "\n"); tok; tok = std::strtok(nullptr, "\n"))
+            lines.push_back(tok);
+        sink = lines.size();
+    }));
+    report("split lines (Swirl_String::split)", best(repeat, [&] {
+        sink = str.split("\n").size();
+    }));
+
+    report("replaceAll (std::string loop)", best(repeat, [&] {
+        std::string copy = text;
+        for (std::size_t pos = 0; (pos = copy.find(needle, pos)) != std::string::npos; pos += 4)
+            copy.replace(pos, needle.size(), "WARN");
+        sink = copy.size();
+    }));
+    report("replaceAll (Swirl_String)", best(repeat, [&] {
+        sink = str.replaceAll(needle, "WARN").length();
+    }));
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+#include <string_view>
+
+#ifndef SWIRL_SCHEDULER_H
+#define SWIRL_SCHEDULER_H
+
+/* One module of a multi-file build, built once all of its `deps` have been built. */
+struct BuildJob {
+    std::string source;                     // path of the .sw file
+    std::vector<std::size_t> deps{};        // indices of the jobs this module imports from
+    std::vector<std::size_t> dependents{};  // indices of the jobs importing this module
+};
+
+/**
+ * @brief Expands the input paths of a build into the list of .sw files to compile
+ *
+ * Directories are searched recursively, skipping __swirl_cache__ directories.
+ */
+std::vector<std::string> collectSources(const std::vector<std::string>& _inputs);
+
+/** @brief returns the module paths `_source` imports through `from <module> import ...` */
+std::vector<std::string> scanImports(std::string_view _source);
+
+/**
+ * @brief Creates one job per source and links each job to the sources it imports
+ *
+ * `from a.b import c` depends on the source whose path, without the extension, ends in `a/b`.
+ * Modules that are not part of the build are left to the compile itself.
+ */
+std::vector<BuildJob> planBuild(const std::vector<std::string>& _sources);
+
+/**
+ * @brief Runs `_run` for every job on a pool of `_workers` threads, in dependency order
+ *
+ * A job whose `_run` returns false fails the build and the jobs depending on it are skipped;
+ * the independent ones still run. Nothing runs if the imports form a cycle.
+ *
+ * @param _err where cyclic imports and skipped jobs are reported
+ * @return true if every job ran and succeeded
+ */
+bool runJobs(const std::vector<BuildJob>& _jobs, unsigned _workers, const std::function<bool(const BuildJob&)>& _run,
+             std::ostream& _err);
+
+#endif
@@ -0,0 +1,51 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <string_view>
+
+#ifndef SWIRL_CACHE_H
+#define SWIRL_CACHE_H
+
+/** @brief 64-bit FNV-1a hash of `_data` as a hex string */
+std::string hashContent(std::string_view _data);
+
+/**
+ * @brief Writes `_prelude` to `_header` and precompiles it with `_cxx`, unless an up to date
+ * precompiled header is already there
+ *
+ * GCC picks `<header>.gch` up by itself; for clang a `.pch` is built instead and passed explicitly.
+ * If precompiling fails the header is still usable as a plain include, and no new attempt is made
+ * until the prelude or the compiler command changes.
+ *
+ * @return the arguments the backend compile needs to use the precompiled header
+ */
+std::vector<std::string> precompilePrelude(const std::string& _header, const std::vector<std::string>& _cxx,
+                                           std::string_view _prelude);
+
+/*
+ * Describes the inputs of a finished build, stored as `<output>.manifest` in __swirl_cache__.
+ * A build whose inputs match the stored manifest (and whose executable still exists) is skipped.
+ */
+struct BuildManifest {
+    std::string source_hash;
+    std::string compiler;
+    std::string command;    // the backend compile command, covers the flags and output path
+    std::string version;    // version of Swirl that generated the C++ code
+
+    /** @brief reads the manifest at `_path`, nothing if it is missing or malformed */
+    static std::optional<BuildManifest> load(const std::string& _path);
+
+    bool save(const std::string& _path) const;
+
+    bool operator==(const BuildManifest&) const = default;
+};
+
+/* What `swirl --server` keeps in memory between requests instead of rereading it from __swirl_cache__. */
+struct BuildCache {
+    std::unordered_map<std::string, BuildManifest>            manifests;  // by manifest path
+    std::unordered_map<std::string, std::vector<std::string>> preludes;   // flags of precompilePrelude, by header and compiler
+};
+
+#endif
@@ -10,7 +10,7 @@
 #define CLI_H_Swirl
 
 const std::string USAGE = R"(The Swirl compiler
-Usage: Swirl <input-file> [flags]
+Usage: Swirl <input-file>... [flags]
 
 Flags:
 )";
@@ -34,6 +34,12 @@ public:
 
 	std::optional<std::string> get_file();
 
+	/** @brief every positional argument, in the order they were given */
+	std::vector<std::string> get_files();
+
+	/** @brief why the arguments could not be parsed (an unknown flag, a missing value), empty if they could */
+	const std::string& error() const { return m_error; }
+
 private:
 	std::vector<Argument> parse();
 
@@ -54,6 +60,7 @@ private:
 	const char ** m_argv;
 
 	const std::vector<Argument> *m_flags;
+  std::string m_error;
   std::vector<Argument> m_args;
 };
 
@@ -0,0 +1,41 @@
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <symbols/Interner.h>
+#include <exception/exception.h>
+#include <transpiler/transpiler.h>
+
+#ifndef SWIRL_COMPILATION_CONTEXT_H
+#define SWIRL_COMPILATION_CONTEXT_H
+
+/**
+ * @brief Owns the state of compiling one file, from the symbols of the tokenizer to the generated code.
+ *
+ * Nothing the front end uses is global, so contexts on different threads don't interfere,
+ * and a fresh context starts without leftovers of an earlier compilation.
+ */
+struct CompilationContext {
+    std::string_view source;    // the file being compiled, for error messages; not owned
+
+    Interner       symbols;
+    CompiledOutput output;
+
+    std::unordered_map<SymbolId, const char*> type_registry;  // registered types and their visibility
+    std::unordered_map<SymbolId, std::string> symbol_table;   // symbols the transpiler has seen and their scope
+
+    std::vector<Diagnostic> diagnostics;  // errors found so far, reported by the driver
+
+    /** @brief registers the built-in types */
+    explicit CompilationContext(std::string_view _source = {});
+
+    /** @brief records an error at `_span` */
+    void error(std::string _message, SourceSpan _span = {}) {
+        diagnostics.push_back({.message = std::move(_message), .span = _span});
+    }
+
+    CompilationContext(const CompilationContext&) = delete;
+    CompilationContext& operator=(const CompilationContext&) = delete;
+};
+
+#endif
@@ -1,17 +1,33 @@
 #include <iostream>
 #include <array>
+#include <cstdint>
+#include <utility>
+#include <string_view>
 
 #ifndef SWIRL_DEFINITIONS_H
 #define SWIRL_DEFINITIONS_H
 
+enum Keyword : uint8_t {
+    KW_NONE, // not a keyword
+
+    KW_FUNC, KW_RETURN, KW_IF, KW_ELSE, KW_FOR, KW_WHILE,
+    KW_IS, KW_IN, KW_OR, KW_AND, KW_CLASS, KW_PUBLIC,
+    KW_PRIVATE, KW_TRUE, KW_FALSE, KW_VAR, KW_CONST, KW_STATIC, KW_BREAK,
+    KW_CONTINUE, KW_ELIF, KW_GLOBAL, KW_IMPORTC, KW_TYPEDEF,
+    KW_IMPORT, KW_EXPORT, KW_FROM
+};
+
 struct defs {
-    std::array<std::string, 27> keywords = {
-            "func", "return", "if", "else", "for", "while",
-            "is", "in", "or", "and", "class", "public",
-            "private" "true", "false", "var", "const", "static", "break",
-            "continue", "elif", "global", "importc", "typedef",
-            "import", "export", "from"
-    };
+    static constexpr std::array<std::pair<std::string_view, Keyword>, 27> keywords = {{
+            {"func", KW_FUNC}, {"return", KW_RETURN}, {"if", KW_IF}, {"else", KW_ELSE},
+            {"for", KW_FOR}, {"while", KW_WHILE}, {"is", KW_IS}, {"in", KW_IN},
+            {"or", KW_OR}, {"and", KW_AND}, {"class", KW_CLASS}, {"public", KW_PUBLIC},
+            {"private", KW_PRIVATE}, {"true", KW_TRUE}, {"false", KW_FALSE}, {"var", KW_VAR},
+            {"const", KW_CONST}, {"static", KW_STATIC}, {"break", KW_BREAK},
+            {"continue", KW_CONTINUE}, {"elif", KW_ELIF}, {"global", KW_GLOBAL},
+            {"importc", KW_IMPORTC}, {"typedef", KW_TYPEDEF}, {"import", KW_IMPORT},
+            {"export", KW_EXPORT}, {"from", KW_FROM}
+    }};
 
     std::array<char, 9> op_chars = {'*', '!', '=', '%', '+', '-', '/', '>', '<'};
 
@@ -19,4 +35,30 @@ struct defs {
     std::array<char, 6> delimiters = {'(', ')', ' ', '\n', ')', '{',};
 };
 
+/* Perfect hash over defs::keywords, the multipliers were picked so that no two keywords share a slot. */
+constexpr std::size_t keywordHash(std::string_view _str) {
+    return (_str.size() * 54 + static_cast<unsigned char>(_str.front())
+            + static_cast<unsigned char>(_str.back()) * 17) & 63;
+}
+
+constexpr std::array<std::pair<std::string_view, Keyword>, 64> KEYWORD_TABLE = [] {
+    std::array<std::pair<std::string_view, Keyword>, 64> table{};
+    for (const auto& kw : defs::keywords)
+        table[keywordHash(kw.first)] = kw;
+    return table;
+}();
+
+static_assert([] {
+    for (const auto& kw : defs::keywords)
+        if (KEYWORD_TABLE[keywordHash(kw.first)].second != kw.second) return false;
+    return true;
+}(), "keywordHash has collisions, pick new multipliers");
+
+/** @brief returns the Keyword `_str` spells, KW_NONE if it is not a keyword */
+constexpr Keyword lookupKeyword(std::string_view _str) {
+    if (_str.empty() || _str.size() > 8) return KW_NONE;
+    const auto& slot = KEYWORD_TABLE[keywordHash(_str)];
+    return slot.first == _str ? slot.second : KW_NONE;
+}
+
 #endif
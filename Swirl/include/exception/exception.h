@@ -1,9 +1,24 @@
+#include <string>
 #include <iostream>
-#include <map>
+#include <string_view>
+
+#include <tokenizer/SourceSpan.h>
 
 #ifndef SWIRL_EXCEPTION_H
 #define SWIRL_EXCEPTION_H
 
-void raiseException(const char*, std::map<const char*, std::size_t>);
+/* An error found while compiling, located by its span; line and column are filled in when it is reported. */
+struct Diagnostic {
+    std::string message;
+    SourceSpan  span{};
+    std::size_t line   = 0;  // 1-based
+    std::size_t column = 0;  // 1-based
+};
+
+/** @brief fills in the line and column of `_diag` and formats it with the source line it points at */
+std::string formatDiagnostic(std::string_view _source, Diagnostic& _diag);
+
+/** @brief prints `_msg` along with the line of `_source` `_span` points at, line/column are only computed here */
+void raiseException(std::string_view _source, const char* _msg, SourceSpan _span);
 
 #endif
@@ -0,0 +1,34 @@
+#include <string>
+#include <vector>
+#include <string_view>
+
+#include <exception/exception.h>
+#include <utils/TimeReport.h>
+
+#ifndef SWIRL_LIBSWIRL_H
+#define SWIRL_LIBSWIRL_H
+
+/* The compiler as a library: Swirl source in, C++ source out, without touching the filesystem. */
+namespace Swirl {
+    struct Options {
+        bool inline_prelude = true;   // paste the runtime prelude in instead of including swirl_prelude.h
+        bool timings        = false;  // fill in Result::timings
+    };
+
+    struct Result {
+        bool                     success = false;
+        std::string              cpp_text;     // the generated translation unit
+        std::vector<Diagnostic>  diagnostics;  // line and column are filled in
+        std::vector<PhaseRecord> timings;      // parse and transpile, if Options::timings is set
+    };
+
+    /**
+     * @brief Compiles `_source` to C++ in memory
+     *
+     * Every call uses its own CompilationContext, so calls can run concurrently and don't see
+     * each other's symbols. Errors end up in the diagnostics, nothing is printed.
+     */
+    Result compile(std::string_view _source, const Options& _opts = {});
+}
+
+#endif
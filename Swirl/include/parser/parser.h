@@ -1,51 +1,128 @@
 #include <tokenizer/Tokenizer.h>
 #include <array>
 #include <map>
-#include <list>
+#include <cstdint>
+
+#include <utils/StringArena.h>
 
 #ifndef SWIRL_PARSER_H
 #define SWIRL_PARSER_H
 
+struct CompilationContext;
+
+using NodeIndex = uint32_t;
+constexpr NodeIndex NO_NODE = UINT32_MAX;
+
+/* A list of sibling nodes, linked through Node::next inside the AST's node arena. */
+struct NodeList {
+    NodeIndex first = NO_NODE;
+    NodeIndex last  = NO_NODE;
+
+    bool empty() const { return first == NO_NODE; }
+};
 
 struct Node {
     bool initialized = false;
     bool format      = false;
 
-    TokenType type;
-    std::string value;
-    std::string ident;
-    std::string ctx_type;
-    std::string from;
-    std::string impr;
+    TokenType type   = _NONE;
+    NodeIndex next   = NO_NODE;
+    SymbolId  symbol = NO_SYMBOL; // interned `value` of IDENT nodes
 
-    std::list<Node> body;
-    std::list<Node> arg_nodes;
-    std::list<Node> template_args;
+    // views into the source buffer or into the AST's string arena
+    std::string_view value;
+    std::string_view ident;
+    std::string_view ctx_type;
+    std::string_view from;
+    std::string_view impr;
 
-    std::unordered_map<std::string, std::size_t> loc;
+    NodeList body;
+    NodeList arg_nodes;
+    NodeList template_args;
+
+    SourceSpan span{};
 };
 
-struct AbstractSyntaxTree {
-    std::list<Node> chl;
+/**
+ * @brief Owns every node of a program in one contiguous vector, children are referred to by index.
+ *
+ * Strings that are not slices of the source (e.g. the text of a condition, which the parser
+ * stitches together from several tokens) are copied into a bump-allocated arena that lives as
+ * long as the tree. Nodes store views, so the source buffer must outlive the tree as well.
+ */
+class AbstractSyntaxTree {
+    std::vector<Node> m_Nodes;
+    StringArena       m_Strings;
+
+public:
+    NodeList chl;
+
+    class Iterator {
+        AbstractSyntaxTree* m_Tree;
+        NodeIndex           m_Index;
+    public:
+        Iterator(AbstractSyntaxTree* _tree, NodeIndex _index) : m_Tree(_tree), m_Index(_index) {}
+        Node& operator*() const { return (*m_Tree)[m_Index]; }
+        Iterator& operator++() { m_Index = (*m_Tree)[m_Index].next; return *this; }
+        bool operator!=(const Iterator& _other) const { return m_Index != _other.m_Index; }
+    };
+
+    struct Range {
+        Iterator b, e;
+        Iterator begin() const { return b; }
+        Iterator end()   const { return e; }
+    };
+
+    Node& operator[](NodeIndex _index) { return m_Nodes[_index]; }
+
+    /** @brief returns the last node of `_list`, which must not be empty */
+    Node& back(NodeList _list) { return m_Nodes[_list.last]; }
+
+    /** @brief iterates over the nodes of `_list` */
+    Range children(NodeList _list) { return {{this, _list.first}, {this, NO_NODE}}; }
+
+    /**
+     * @brief copies `_node` into the arena and links it at the end of a list
+     *
+     * @param _parent the node owning the list, NO_NODE for the top level (`chl`)
+     * @param _list which of the parent's lists to append to, ignored for the top level
+     * @return the index of the new node
+     */
+    NodeIndex append(const Node& _node, NodeIndex _parent = NO_NODE, NodeList Node::* _list = nullptr);
+
+    /** @brief copies `_str` into the string arena, the returned view lives as long as the tree */
+    std::string_view store(std::string_view _str) { return m_Strings.store(_str); }
+
+    std::size_t nodeCount() const { return m_Nodes.size(); }
+
+    /** @brief bytes held by the node vector and the string arena */
+    std::size_t memoryUsage() const { return m_Nodes.capacity() * sizeof(Node) + m_Strings.size(); }
 };
 
 class Parser {
     Token cur_rd_tok{};
+    CompilationContext& m_Ctx;
+
+    // state of the function being read
+    short   ang_ind      = 0;
+    uint8_t rd_param     = 0;
+    uint8_t rd_func      = 0;
+    uint8_t rd_param_cnt = 0;
 public:
     TokenStream m_Stream;
     AbstractSyntaxTree* m_AST;
     bool m_AppendToScope = false;
-    std::vector<std::string> registered_symbols{};
+    std::vector<SymbolId> registered_symbols{};
 
-    explicit Parser(TokenStream&);
+    Parser(TokenStream&, CompilationContext&);
 
     void parseCondition(TokenType);
-    void parseCall(const char*);
+    void parseCall(std::string_view, SourceSpan);
     void dispatch();
     void parseFunction();
-    void parseDecl(const char*, const char*);
+    void parseDecl(std::string_view, std::string_view);
     void parseLoop(TokenType);
-    void appendAST(Node&);
+    NodeIndex appendAST(Node&);
     inline void next(bool swsFlg = false, bool snsFlg = false );
 
     ~Parser();
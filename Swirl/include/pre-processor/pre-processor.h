@@ -6,5 +6,5 @@
 
 #ifndef PRE_PROCESSOR_H_SWIRL
 #define PRE_PROCESSOR_H_SWIRL
-void preProcess(const std::string&, TokenStream&, std::string);
+void preProcess(TokenStream&, std::string);
 #endif
\ No newline at end of file
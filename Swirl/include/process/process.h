@@ -0,0 +1,52 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <string_view>
+
+#ifndef SWIRL_PROCESS_H
+#define SWIRL_PROCESS_H
+
+struct ProcessResult {
+    int exit_code = -1;  // 128 + signal number if the process was killed, 127 if it couldn't be started,
+                         // -1 if its exit status could not be collected
+    std::string output;  // what the process wrote to stderr (and stdout, if captured)
+
+    bool ok() const { return exit_code == 0; }
+};
+
+/**
+ * @brief A child process started without a shell (through cmd.exe on Windows), `args[0]` is searched in PATH.
+ *
+ * Its stderr (and optionally stdout) goes to a pipe that wait() drains, so several processes
+ * can run at once without their diagnostics interleaving.
+ */
+class Process {
+#if defined(_WIN32)
+    std::FILE* m_Pipe = nullptr;
+#else
+    int m_Pid  = -1;
+    int m_Pipe = -1;
+#endif
+    std::string m_Error;
+
+public:
+    /** @param _captureStdout collect stdout along with stderr, on Windows it always is */
+    Process(const std::vector<std::string>& _args, bool _captureStdout = false);
+    Process(const Process&) = delete;
+    Process& operator=(const Process&) = delete;
+    ~Process();
+
+    /** @brief collects the output of the process and waits for it to exit */
+    ProcessResult wait();
+};
+
+/** @brief starts `_args` and waits for it, see Process */
+ProcessResult runProcess(const std::vector<std::string>& _args, bool _captureStdout = false);
+
+/** @brief splits a command given on the command line (e.g. `-c "clang++ -O2"`) into arguments */
+std::vector<std::string> splitCommand(std::string_view _command);
+
+/** @brief joins `_args` back into one line, for logs and build manifests */
+std::string joinCommand(const std::vector<std::string>& _args);
+
+#endif
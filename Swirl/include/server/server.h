@@ -0,0 +1,40 @@
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+
+#ifndef SWIRL_SERVER_H
+#define SWIRL_SERVER_H
+
+/*
+ * `swirl --server` keeps one process around so builds skip process startup and reuse what the
+ * server has cached in memory. A request is the argument list of a swirl run (file paths made
+ * absolute by the client), the reply is everything the run printed and its exit code.
+ *
+ * The socket is only accessible to the user running the server, connections from other users are
+ * closed unanswered, and so are clients that send nothing for 5 seconds. An exception thrown by the
+ * handler is reported to the client as a failed run.
+ *
+ * Frames on the socket are little-endian uint32 lengths followed by the bytes:
+ *   request: <count> then <length><argument> for each argument
+ *   reply:   <length><output> then <exit code as uint32>
+ */
+
+using RequestHandler = std::function<int(const std::vector<std::string>& _args, std::ostream& _out)>;
+
+/** @brief `$XDG_RUNTIME_DIR/swirl.sock`, or `/tmp/swirl-<uid>.sock` */
+std::string defaultSocketPath();
+
+/**
+ * @brief Listens on the Unix socket `_socket` and answers requests one at a time until killed
+ * @return non-zero if the socket could not be set up
+ */
+int runServer(const std::string& _socket, const RequestHandler& _handler);
+
+/**
+ * @brief Sends `_args` to the server at `_socket` and prints its output
+ * @return the exit code of the remote run, -1 if no server answered
+ */
+int requestServer(const std::string& _socket, const std::vector<std::string>& _args);
+
+#endif
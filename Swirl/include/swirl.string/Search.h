@@ -0,0 +1,65 @@
+#include <cstring>
+#include <cstddef>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SWIRL_STR_SSE2
+#endif
+
+#ifndef Swirl_SEARCH_H
+#define Swirl_SEARCH_H
+
+namespace Swirl {
+    constexpr std::size_t npos = std::string_view::npos;
+
+    /**
+     * @brief Index of the first occurrence of `_needle` in `_hay` at or after `_from`, npos if there is none
+     *
+     * With SSE2, 32 candidate positions are tested at a time by comparing the first and the last byte
+     * of the needle against the haystack. Only positions where both match are compared in full, which
+     * on text leaves very few. Without SSE2, memchr finds the candidates for the first byte.
+     */
+    inline std::size_t search(std::string_view _hay, std::string_view _needle, std::size_t _from = 0) {
+        if (_from > _hay.size() || _needle.size() > _hay.size() - _from) return npos;
+        if (_needle.empty()) return _from;
+
+        const char* hay  = _hay.data();
+        std::size_t last = _needle.size() - 1;
+        std::size_t end  = _hay.size() - last; // one past the last possible start
+        std::size_t pos  = _from;
+
+#ifdef SWIRL_STR_SSE2
+        const __m128i first_chr = _mm_set1_epi8(_needle.front());
+        const __m128i last_chr  = _mm_set1_epi8(_needle.back());
+
+        auto candidates = [&](std::size_t _at) {
+            __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + _at));
+            __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + _at + last));
+            return static_cast<unsigned int>(_mm_movemask_epi8(
+                    _mm_and_si128(_mm_cmpeq_epi8(head, first_chr), _mm_cmpeq_epi8(tail, last_chr))));
+        };
+
+        // two blocks per iteration, so a run without candidates costs a single branch per 32 bytes
+        for (; pos + 32 <= end; pos += 32) {
+            unsigned int hits = candidates(pos) | candidates(pos + 16) << 16;
+            for (; hits; hits &= hits - 1) {
+                std::size_t cand = pos + __builtin_ctz(hits);
+                if (std::memcmp(hay + cand + 1, _needle.data() + 1, last) == 0) return cand;
+            }
+        }
+#endif
+
+        while (pos < end) {
+            auto hit = static_cast<const char*>(std::memchr(hay + pos, _needle.front(), end - pos));
+            if (!hit) return npos;
+
+            pos = hit - hay;
+            if (std::memcmp(hay + pos + 1, _needle.data() + 1, last) == 0) return pos;
+            ++pos;
+        }
+        return npos;
+    }
+}
+
+#endif
@@ -2,40 +2,101 @@
 #include <string>
 #include <cstring>
 #include <vector>
+#include <string_view>
+
+#include <swirl.string/Search.h>
 
 #ifndef Swirl_STRING_H
 #define Swirl_STRING_H
 
+/**
+ * @brief An owning string with a cached length.
+ *
+ * Strings of up to SSO_CAPACITY chars are kept inline in the object, longer ones on the heap with
+ * capacity doubling on growth. The buffer is always null terminated, so __to_cstr__() is free.
+ */
 class Swirl_String
 {
+    static constexpr std::size_t SSO_CAPACITY = 15;
+
+    char*       m_Data;
+    std::size_t m_Size = 0;
+    union {
+        std::size_t m_Capacity;
+        char        m_Local[SSO_CAPACITY + 1];
+    };
+
+    bool isLocal() const { return m_Data == m_Local; }
+
+    /** @brief grows the buffer to hold at least `_capacity` chars, keeping the contents */
+    void grow(std::size_t _capacity);
+
+    /** @brief copies `_size` chars of `_str` in place of the contents */
+    void assign(const char* _str, std::size_t _size);
+
+    /** @brief takes over the buffer of `_other` and leaves it empty, the old buffer must be released */
+    void steal(Swirl_String& _other);
+
 public:
-    char *value;
-    Swirl_String(char *val);
-    Swirl_String(std::string val);
-    Swirl_String(const char *val);
-    Swirl_String operator+(Swirl_String str);
-    Swirl_String operator*(int num);
+    Swirl_String() : m_Data(m_Local) { m_Local[0] = '\0'; }
+    Swirl_String(const char* _str, std::size_t _size) : m_Data(m_Local) { assign(_str, _size); }
+    Swirl_String(std::string_view _str) : Swirl_String(_str.data(), _str.size()) {}
+    Swirl_String(const std::string& _str) : Swirl_String(_str.data(), _str.size()) {}
+    Swirl_String(const char* _str) : Swirl_String(_str, std::strlen(_str)) {}
 
-    bool operator==(Swirl_String comp);
-    bool operator!=(Swirl_String comp);
-    bool has(Swirl_String str);
+    Swirl_String(const Swirl_String& _other) : Swirl_String(_other.m_Data, _other.m_Size) {}
+    Swirl_String(Swirl_String&& _other) noexcept { steal(_other); }
+    Swirl_String& operator=(const Swirl_String& _other);
+    Swirl_String& operator=(Swirl_String&& _other) noexcept;
+    ~Swirl_String() { if (!isLocal()) delete[] m_Data; }
 
-    int length();
-    bool isEmpty();
-    std::vector<Swirl_String> split(Swirl_String chr);
+    Swirl_String& operator+=(std::string_view _str);
+    Swirl_String operator+(std::string_view _str) const;
+    /** @brief the string repeated `_num` times */
+    Swirl_String operator*(int _num) const;
 
-    Swirl_String erase(Swirl_String str);
+    bool operator==(std::string_view _comp) const { return view() == _comp; }
+    bool operator!=(std::string_view _comp) const { return view() != _comp; }
+    bool has(std::string_view _str) const { return Swirl::search(view(), _str) != Swirl::npos; }
 
-    int find(Swirl_String str);
+    std::size_t length() const { return m_Size; }
+    std::size_t capacity() const { return isLocal() ? SSO_CAPACITY : m_Capacity; }
+    bool isEmpty() const { return m_Size == 0; }
+    void reserve(std::size_t _capacity) { if (_capacity > capacity()) grow(_capacity); }
 
-    Swirl_String replace(Swirl_String before, Swirl_String after);
-    int toInt();
-    double toFloat();
-    double toBool();
+    /**
+     * @brief the pieces between the occurrences of `_sep`, empty ones included
+     *
+     * The pieces are views into this string, they are invalidated by any change to it.
+     */
+    std::vector<std::string_view> split(std::string_view _sep) const;
 
-    const char *__rr__();
-    const char *__to_cstr__();
-    std::string __to_cpp_str__();
+    /** @brief the string without the first occurrence of `_str` */
+    [[nodiscard]] Swirl_String erase(std::string_view _str) const;
+
+    /** @brief index of the first occurrence of `_str`, -1 if there is none */
+    long long find(std::string_view _str) const;
+
+    /** @brief the string with the first occurrence of `_before` replaced by `_after` */
+    Swirl_String replace(std::string_view _before, std::string_view _after) const;
+
+    /** @brief the string with every occurrence of `_before` replaced by `_after`, in a single pass */
+    Swirl_String replaceAll(std::string_view _before, std::string_view _after) const;
+
+    int toInt() const { return std::atoi(m_Data); }
+    double toFloat() const { return std::atof(m_Data); }
+    bool toBool() const { return m_Size != 0; }
+
+    operator std::string_view() const { return view(); }
+    std::string_view view() const { return {m_Data, m_Size}; }
+
+    const char *__rr__() const { return ""; }
+    const char *__to_cstr__() const { return m_Data; }
+    std::string __to_cpp_str__() const { return {m_Data, m_Size}; }
 };
 
+inline std::ostream& operator<<(std::ostream& _out, const Swirl_String& _str) {
+    return _out << _str.view();
+}
+
 #endif
@@ -0,0 +1,38 @@
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include <utils/StringArena.h>
+
+#ifndef SWIRL_INTERNER_H
+#define SWIRL_INTERNER_H
+
+using SymbolId = uint32_t;
+constexpr SymbolId NO_SYMBOL = UINT32_MAX;
+
+/**
+ * @brief Maps every distinct identifier to a dense 32-bit id
+ *
+ * Interning the same text twice returns the same id, so tables keyed by SymbolId compare and
+ * hash integers instead of strings. The text of a symbol is owned by the interner.
+ */
+class Interner {
+    StringArena                                  m_Arena;
+    std::vector<std::string_view>                m_Strings;
+    std::unordered_map<std::string_view, SymbolId> m_Ids;
+
+public:
+    /** @brief returns the id of `_str`, registering it on first sight */
+    SymbolId intern(std::string_view _str);
+
+    /** @brief returns the id of `_str`, NO_SYMBOL if it was never interned */
+    SymbolId find(std::string_view _str) const;
+
+    /** @brief returns the text of `_id` */
+    std::string_view view(SymbolId _id) const;
+
+    std::size_t size() const;
+};
+
+#endif
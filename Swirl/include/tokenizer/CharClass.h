@@ -0,0 +1,96 @@
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SWIRL_LEX_SSE2
+#endif
+
+#ifndef SWIRL_CHAR_CLASS_H
+#define SWIRL_CHAR_CLASS_H
+
+/* Bit flags describing which lexical classes a byte belongs to. */
+enum CharClass : uint8_t {
+    CC_DIGIT      = 1 << 0,
+    CC_ID_START   = 1 << 1,
+    CC_ID         = 1 << 2,
+    CC_OP         = 1 << 3,
+    CC_WHITESPACE = 1 << 4,
+    CC_PUNC       = 1 << 5,
+};
+
+/* 256-entry lookup table, indexed by the unsigned value of a char. */
+constexpr std::array<uint8_t, 256> CHAR_CLASS = [] {
+    std::array<uint8_t, 256> table{};
+    auto mark = [&table](std::string_view _chars, uint8_t _class) {
+        for (char chr : _chars) table[static_cast<unsigned char>(chr)] |= _class;
+    };
+
+    mark("1234567890", CC_DIGIT | CC_ID);
+    mark("_ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz", CC_ID_START | CC_ID);
+    mark("\"?!-=", CC_ID);
+    mark("!=*&<>-/+^%", CC_OP);
+    mark(" \t\n", CC_WHITESPACE);
+    mark("();,{}[]", CC_PUNC);
+    return table;
+}();
+
+constexpr bool hasClass(char _chr, uint8_t _class) {
+    return CHAR_CLASS[static_cast<unsigned char>(_chr)] & _class;
+}
+
+#ifdef SWIRL_LEX_SSE2
+/** @brief returns a 16-bit mask of the bytes of `_chunk` that belong to `Class` */
+template <uint8_t Class>
+inline unsigned int classMask(__m128i _chunk) {
+    auto in_range = [_chunk](char _lo, char _hi) {
+        return _mm_and_si128(
+                _mm_cmpgt_epi8(_chunk, _mm_set1_epi8(static_cast<char>(_lo - 1))),
+                _mm_cmplt_epi8(_chunk, _mm_set1_epi8(static_cast<char>(_hi + 1))));
+    };
+    auto equals = [_chunk](char _chr) { return _mm_cmpeq_epi8(_chunk, _mm_set1_epi8(_chr)); };
+
+    __m128i hits = in_range('0', '9');
+    if constexpr (Class == CC_ID) {
+        hits = _mm_or_si128(hits, in_range('A', 'Z'));
+        hits = _mm_or_si128(hits, in_range('a', 'z'));
+        hits = _mm_or_si128(hits, equals('_'));
+        hits = _mm_or_si128(hits, equals('"'));
+        hits = _mm_or_si128(hits, equals('?'));
+        hits = _mm_or_si128(hits, equals('!'));
+        hits = _mm_or_si128(hits, equals('-'));
+        hits = _mm_or_si128(hits, equals('='));
+    }
+    return static_cast<unsigned int>(_mm_movemask_epi8(hits));
+}
+#endif
+
+/**
+ * @brief Length of the longest prefix of `_str` made of `Class` chars
+ *
+ * CC_ID and CC_DIGIT runs are scanned 16 bytes at a time when SSE2 is available,
+ * every other class (and the tail of the input) goes through the lookup table.
+ */
+template <uint8_t Class>
+inline std::size_t spanOf(std::string_view _str) {
+    std::size_t len = 0;
+
+#ifdef SWIRL_LEX_SSE2
+    if constexpr (Class == CC_ID || Class == CC_DIGIT) {
+        while (len + 16 <= _str.size()) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_str.data() + len));
+            unsigned int misses = ~classMask<Class>(chunk) & 0xFFFF;
+            if (misses) return len + __builtin_ctz(misses);
+            len += 16;
+        }
+    }
+#endif
+
+    while (len < _str.size() && hasClass(_str[len], Class))
+        ++len;
+    return len;
+}
+
+#endif
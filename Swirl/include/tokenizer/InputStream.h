@@ -1,15 +1,23 @@
 #include <iostream>
 #include <vector>
+#include <string_view>
+
+#include <tokenizer/SourceSpan.h>
 
 #ifndef INPUT_STREAM_H_Swirl
 #define INPUT_STREAM_H_Swirl
 
 
 class InputStream {
-    std::string m_Source{};
-    std::size_t m_Pos = 0, m_Line = 1, m_Col = 0;
+    std::string_view m_Source{};
+    std::size_t m_Pos = 0;
+    uint32_t m_FileId = 0;
 public:
-    explicit InputStream(std::string& _source);
+    /**
+     * @brief the stream does not own `_source`, it must outlive the stream and every token read from it.
+     * The byte right after `_source` must be readable (e.g. the NUL of a std::string or SourceFile's sentinel)
+     */
+    explicit InputStream(std::string_view _source, uint32_t _fileId = 0);
 
     /** @brief Returns the next value without discarding it */
     char peek();
@@ -23,9 +31,22 @@ public:
     /** @brief resets the state of the stream */
     void reset();
 
+    /** @brief returns the part of the source that has not been consumed yet */
+    std::string_view rest() const;
+
+    /** @brief discards `_count` chars */
+    void skip(std::size_t _count);
+
+    /** @brief returns a view of the source from `_begin` up to the current position */
+    std::string_view slice(std::size_t _begin) const;
+
+    /** @brief returns a view of the source in the range [_begin, _end) */
+    std::string_view slice(std::size_t _begin, std::size_t _end) const;
+
+    /** @brief returns the span from `_begin` up to the current position */
+    SourceSpan span(std::size_t _begin) const;
+
     std::size_t getPos() const;
-    std::size_t getLine() const;
-    std::size_t getCol() const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include <string>
+#include <string_view>
+
+#ifndef SWIRL_SOURCE_FILE_H
+#define SWIRL_SOURCE_FILE_H
+
+/**
+ * @brief Read-only view of a source file, memory-mapped where the platform allows it
+ *
+ * The contents are followed by a newline (the tokenizer expects every file to end with one)
+ * and a NUL sentinel byte, so the InputStream can peek one char past the end without
+ * bounds checks. Falls back to reading the file into memory if it cannot be mapped.
+ */
+class SourceFile {
+    char*            m_Map     = nullptr;
+    std::size_t      m_MapSize = 0;
+    std::string      m_Fallback{};
+    std::string_view m_Source{};
+public:
+    explicit SourceFile(const std::string& _path);
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+    ~SourceFile();
+
+    /** @brief returns the contents of the file, including the appended newline */
+    std::string_view view() const;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <string_view>
+
+#ifndef SWIRL_SOURCE_SPAN_H
+#define SWIRL_SOURCE_SPAN_H
+
+/* Location of a token or node: a byte range of one source file. */
+struct SourceSpan {
+    uint32_t file_id = 0;
+    uint32_t offset  = 0;
+    uint32_t length  = 0;
+};
+
+static_assert(sizeof(SourceSpan) == 12);
+
+/**
+ * @brief Translates byte offsets of a source into line/column pairs
+ *
+ * The line-start table is only built on the first lookup, so compilations that never
+ * print a diagnostic never scan the source for newlines.
+ */
+class LineIndex {
+    std::string_view              m_Source;
+    mutable std::vector<uint32_t> m_Starts{};
+
+    void build() const;
+public:
+    explicit LineIndex(std::string_view _source) : m_Source(_source) {}
+
+    /** @brief returns the 1-based line and 0-based column of `_offset` */
+    std::pair<std::size_t, std::size_t> locate(uint32_t _offset) const;
+
+    /** @brief returns the text of the 1-based `_line`, without its newline */
+    std::string_view line(std::size_t _line) const;
+};
+
+#endif
@@ -4,11 +4,12 @@
 #include <array>
 #include <vector>
 #include <cstring>
-#include <functional>
+#include <algorithm>
 #include <string_view>
 
 #include <definitions/definitions.h>
 #include <tokenizer/InputStream.h>
+#include <tokenizer/CharClass.h>
 #include <utils/utils.h>
 #include <tokens/Tokens.h>
 
@@ -17,15 +18,13 @@
 
 #define SWIRL_TokenStream_H
 
-const defs DEF{};
 using namespace std::string_view_literals;
 
 class TokenStream {
     bool                                            m_Debug  = 0;
     bool                                            m_rdfs   = 0;
-    std::string                                     m_Ret;
-    std::string                                     m_Rax;
     InputStream                                     m_Stream;
+    Interner*                                       m_Symbols;
     Token                                           m_PeekTk = {_NONE, ""};
     Token                                           m_lastTok{};
     Token                                           m_Cur{};
@@ -34,114 +33,106 @@ public:
     Token p_CurTk{_NONE, ""};
     Token p_PeekTk{_NONE, ""};
 
-    explicit TokenStream(InputStream& _stream, bool _debug = false) : m_Stream(_stream), m_Debug(_debug) {}
+    /** @brief identifiers are interned into `_symbols`, which must outlive the stream */
+    TokenStream(InputStream& _stream, Interner& _symbols, bool _debug = false)
+        : m_Debug(_debug), m_Stream(_stream), m_Symbols(&_symbols) {}
 
-    static bool isKeyword(const std::string& _str) {
-        return std::find(DEF.keywords.begin(), DEF.keywords.end(), _str) != DEF.keywords.end();
+    static bool isKeyword(std::string_view _str) {
+        return lookupKeyword(_str) != KW_NONE;
     }
 
     static bool isDigit(char _chr) {
-        return "1234567890"sv.find(_chr) != std::string::npos;
+        return hasClass(_chr, CC_DIGIT);
     }
 
     static bool isId(char chr) {
-        return isIdStart(chr) || "\"?!-=0123456789"sv.find(chr) != std::string::npos;
+        return hasClass(chr, CC_ID);
     }
 
     static bool isIdStart(char _chr) {
-        return "_ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"sv.find(
-                _chr
-        ) != std::string::npos;
+        return hasClass(_chr, CC_ID_START);
     }
 
     static bool isPunctuation(char chr) {
-        return "();,{}[]"sv.find(chr) >= 0;
+        return hasClass(chr, CC_PUNC);
     }
 
     static bool isOpChar(char _chr) {
-        return "!=*&<>-/+^%"sv.find(_chr) != std::string::npos;
+        return hasClass(_chr, CC_OP);
     }
 
     static bool isWhiteSpace(char _chr) {
-        return " \t\n"sv.find(_chr) != std::string::npos;
+        return hasClass(_chr, CC_WHITESPACE);
     }
 
-    std::string readWhile(const std::function<bool (char)>& delimiter) {
-        std::string ret;
-        while (!m_Stream.eof()) {
-            if (delimiter(m_Stream.peek())) {
-                ret += m_Stream.next();
-            } else {break;}
-        }
-        return ret;
+    /** @brief consumes the run of chars belonging to `Class` */
+    template <uint8_t Class>
+    std::string_view readWhile() {
+        std::size_t begin = m_Stream.getPos();
+        m_Stream.skip(spanOf<Class>(m_Stream.rest()));
+        return m_Stream.slice(begin);
     }
 
-    std::string readEscaped(char _end, char apnd = 0) {
-        uint8_t is_escaped = false;
-        std::string ret;
+    /** @brief consumes the opening char and everything up to `_end`, returns the text in between */
+    std::string_view readEscaped(char _end) {
+        bool is_escaped = false;
 
         m_Stream.next();
+        std::size_t begin = m_Stream.getPos(), end = begin;
         while (!m_Stream.eof()) {
             char chr = m_Stream.next();
-            if (is_escaped) {
-                ret += chr;
+            if (is_escaped)
                 is_escaped = false;
-            } else if (chr == '\\') {
-                ret += '\\';
+            else if (chr == '\\')
                 is_escaped = true;
-            }
             else if (chr == _end)
                 break;
-            else
-                ret += chr;
+            end = m_Stream.getPos();
         }
-        if (!apnd) ret += apnd;
-        return ret;
+        return m_Stream.slice(begin, end);
     }
 
     Token readString(char del = '"', bool _format = false) {
-        m_Ret = readEscaped(del);
-        m_Ret.pop_back();
-        m_Ret.insert(0, "\"");
-        m_Ret.append("\"");
-        if (_format) { m_Ret.insert(0, "f"); m_rdfs = false; }
-        return {STRING, m_Ret.c_str()};
+        // the token spans the quotes and the `f` prefix of format strings
+        std::size_t begin = m_Stream.getPos() - _format;
+        readEscaped(del);
+        if (_format) m_rdfs = false;
+        return {STRING, m_Stream.slice(begin)};
     }
 
     Token readMacro() {
-        m_Stream.next(true);
-        if (m_Stream.next(true) == 't') {
-            m_Ret.replace(0, 6, "typedef");
-        }
-
-        m_Ret = readEscaped('\n');
-        return {MACRO, m_Ret.c_str()};
+        return {MACRO, readEscaped('\n')};
     }
 
     Token readIdent(bool apndF = false) {
-        m_Rax = readWhile(isId);
-        if (apndF) m_Rax.insert(0, "f");
-        return {
-                isKeyword(m_Rax) ? KEYWORD : IDENT,
-                m_Rax.c_str()
-        };
+        std::size_t begin = m_Stream.getPos() - apndF;
+        readWhile<CC_ID>();
+        std::string_view ident = m_Stream.slice(begin);
+        Keyword keyword = lookupKeyword(ident);
+        if (keyword != KW_NONE) return {KEYWORD, ident, keyword};
+        return {IDENT, ident, KW_NONE, m_Symbols->intern(ident)};
     }
 
     Token readNumber() {
-        static uint8_t has_decim = false;
-        std::string number = readWhile([](char ch) {
-            if (ch == '.') {
-                if (has_decim) return false;
-                has_decim = true;
-                return true;
-            } return isDigit(ch);
-        });
-        has_decim = false;
-        m_Ret = number;
-        return {NUMBER, m_Ret.c_str()};
+        std::size_t begin = m_Stream.getPos();
+        readWhile<CC_DIGIT>();
+        // `0..100` is a range, not the float `0.` followed by `.100`
+        std::string_view rest = m_Stream.rest();
+        if (!rest.empty() && rest[0] == '.' && !(rest.size() > 1 && rest[1] == '.')) {
+            m_Stream.next();
+            readWhile<CC_DIGIT>();
+        }
+        return {NUMBER, m_Stream.slice(begin)};
     }
 
     Token readNextTok(bool _noIncrement = false) {
+        std::size_t begin = m_Stream.getPos();
+        Token tok = lexToken();
+        tok.span = m_Stream.span(begin);
+        return tok;
+    }
+
+    Token lexToken() {
         if (m_Stream.eof()) {return {NONE, "null"};}
         auto chr = m_Stream.peek();
         if (chr == '"') return readString();
@@ -159,20 +150,21 @@ public:
 
         if (isIdStart(chr)) return readIdent();
 
-        m_Ret = std::string(1, m_Stream.next());
+        std::size_t begin = m_Stream.getPos();
+        m_Stream.next();
 
         if (isOpChar(chr)) {
-            m_Rax = chr + readWhile(isOpChar);
+            readWhile<CC_OP>();
             return {
                     OP,
-                    m_Rax.c_str()
+                    m_Stream.slice(begin)
             };
         }
 
-        if (isPunctuation(chr) ) return {
-                    PUNC,
-                    m_Ret.c_str()
-            };
+        return {
+                PUNC,
+                m_Stream.slice(begin)
+        };
     }
 
     Token next(const bool& _showTNw = false, const bool& _showTWs = false) {
@@ -188,7 +180,7 @@ public:
                 m_PeekTk = readNextTok();
 
         if (m_Debug)
-            std::cout << "Token Requested:\t" << p_CurTk.type << "\t  " << p_CurTk.value << std::endl;
+            std::cout << "Token Requested:\t" << p_CurTk.type << "\t  " << p_CurTk.value << '\n';
 
         return p_CurTk;
     }
@@ -201,14 +193,6 @@ public:
         return false;
     }
 
-    std::map<const char*, std::size_t> getStreamState() {
-        std::map<const char*, std::size_t> stream_state;
-        stream_state["LINE"] = m_Stream.getLine();
-        stream_state["POS"] = m_Stream.getPos();
-        stream_state["COL"] = m_Stream.getCol();
-        return stream_state;
-    }
-
     void resetState() {
         m_Stream.reset();
     }
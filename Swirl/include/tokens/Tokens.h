@@ -1,3 +1,9 @@
+#include <string_view>
+
+#include <definitions/definitions.h>
+#include <symbols/Interner.h>
+#include <tokenizer/SourceSpan.h>
+
 #ifndef SWIRL_TOKENS_H
 #define SWIRL_TOKENS_H
 
@@ -36,9 +42,13 @@ enum TokenType {
     _NONE, // to be used in the parser, "" will be replaced with this
 };
 
+/** @brief A lexeme, `value` is a view into the InputStream's source buffer */
 struct Token {
     TokenType type;
-    std::string value;
+    std::string_view value;
+    Keyword keyword = KW_NONE;     // set for KEYWORD tokens
+    SymbolId symbol = NO_SYMBOL;   // set for IDENT tokens
+    SourceSpan span{};
 };
 
 #endif //SWIRL_TOKENS_H
@@ -1,13 +1,63 @@
 #include <optional>
+#include <fstream>
 #include <parser/parser.h>
 
 #ifndef SWIRL_TRANSPILER_H
 #define SWIRL_TRANSPILER_H
 
-extern std::string compiled_source;
-std::optional<std::unordered_map<std::string, std::string>> Transpile( std::list<Node>&,
+/* Name of the header, in __swirl_cache__, the runtime prelude is written to and precompiled from. */
+#define SWIRL_PRELUDE_HEADER "swirl_prelude.h"
+
+/* Runtime helpers (print, input, range) every generated program includes. */
+extern const std::string RUNTIME_PRELUDE;
+
+/*
+ * The generated C++ file, kept as separate sections so none of them has to be spliced into another.
+ * Once `funcs` or `main` grow past SPILL_THRESHOLD their finished part is moved to a part file
+ * next to the build file, so memory use is bounded by the threshold plus the largest function.
+ */
+struct CompiledOutput {
+    static constexpr std::size_t SPILL_THRESHOLD = 1 << 20;
+    static constexpr std::size_t SPILL_KEEP      = 16;
+
+    std::string prelude;    // includes RUNTIME_PRELUDE, first so a precompiled header can be used
+    std::string includes;   // `importc`ed headers
+    std::string macros;     // keyword macros, typedefs and `#` directives
+    std::string funcs;      // function definitions
+    std::string main;       // the body of main()
+
+    std::ofstream funcs_part; // `<build file>.funcs.part`, the functions spilled so far
+    std::ofstream main_part;  // `<build file>.main.part`
+
+    /** @brief starts out with the prelude include and the keyword macros */
+    CompiledOutput();
+
+    /** @brief appends all but the last `_keep` chars of `_section` (funcs or main) to its part file */
+    void spill(const std::string& _buildFile, std::string& _section, std::size_t _keep = 0);
+
+    /**
+     * @brief writes the sections to `_path` in order, merging in and removing the part files.
+     * Without part files this is a single writev call where available
+     */
+    bool write(const std::string& _path);
+
+    /** @brief the sections as one string, for output that was never spilled */
+    std::string str() const;
+};
+
+struct CompilationContext;
+
+/**
+ * @brief generates the code of `_nodes` into `_dest`, a section of the context's output
+ *
+ * Sections are spilled to part files next to `_buildFile` as they grow, pass an empty path to
+ * keep everything in memory. Writing the output is up to the caller.
+ */
+std::optional<std::unordered_map<SymbolId, std::string>> Transpile( CompilationContext&,
+                AbstractSyntaxTree&,
+                NodeList,
                 const std::string&,
-                std::string& _dest = compiled_source,
+                std::string& _dest,
                 bool onlyAppend = false,
                 bool returnSymbolTable = false );
 
@@ -0,0 +1,48 @@
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <string_view>
+
+#ifndef SWIRL_STRING_ARENA_H
+#define SWIRL_STRING_ARENA_H
+
+/* Bump allocator for strings, the views it hands out stay valid until the arena is destroyed. */
+class StringArena {
+    static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> m_Blocks;
+    char*                                m_BlockCur   = nullptr;
+    std::size_t                          m_BlockLeft  = 0;
+    std::size_t                          m_Bytes      = 0;
+
+public:
+    /** @brief copies `_str` into the arena */
+    std::string_view store(std::string_view _str) {
+        if (_str.empty()) return {};
+
+        // strings too big for a block get one of their own, the current block stays in use
+        if (_str.size() > BLOCK_SIZE / 4) {
+            char* mem = m_Blocks.emplace_back(new char[_str.size()]).get();
+            m_Bytes += _str.size();
+            std::copy(_str.begin(), _str.end(), mem);
+            return {mem, _str.size()};
+        }
+
+        if (_str.size() > m_BlockLeft) {
+            m_BlockCur  = m_Blocks.emplace_back(new char[BLOCK_SIZE]).get();
+            m_BlockLeft = BLOCK_SIZE;
+            m_Bytes    += BLOCK_SIZE;
+        }
+
+        char* mem = m_BlockCur;
+        std::copy(_str.begin(), _str.end(), mem);
+        m_BlockCur  += _str.size();
+        m_BlockLeft -= _str.size();
+        return {mem, _str.size()};
+    }
+
+    /** @brief bytes allocated for blocks so far */
+    std::size_t size() const { return m_Bytes; }
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+#ifndef SWIRL_TIME_REPORT_H
+#define SWIRL_TIME_REPORT_H
+
+/*
+ * Allocations made through operator new since startup. They are only counted in programs that link
+ * utils/AllocationCounter.cpp, which replaces the global operator new; libswirl leaves it to its host.
+ */
+uint64_t allocationCount();
+uint64_t allocatedBytes();
+void countAllocation(std::size_t _size);
+
+struct PhaseRecord {
+    std::string name;
+    int64_t     start_us    = 0;  // relative to the creation of the report
+    int64_t     duration_us = 0;
+    uint64_t    allocations = 0;
+    uint64_t    alloc_bytes = 0;
+    long        peak_rss_kb = 0;  // of swirl, or of the child processes if they peaked higher
+    unsigned    thread      = 1;  // numbered in the order threads first end a phase, from 1
+};
+
+/**
+ * @brief Wall time, allocations and peak RSS of each phase of a build, for `--time-report`.
+ *
+ * Phases are measured by the Scope objects phase() returns. A disabled report hands out
+ * scopes that do nothing, so the phases can stay instrumented in normal builds. Scopes may end on
+ * several threads at once; the allocations of a phase are then those of the whole process.
+ */
+class TimeReport {
+    using Clock = std::chrono::steady_clock;
+
+    bool                     m_Enabled = false;
+    Clock::time_point        m_Start   = Clock::now();
+    uint64_t                 m_StartAllocations = allocationCount();
+    uint64_t                 m_StartAllocBytes  = allocatedBytes();
+    std::vector<PhaseRecord> m_Phases;
+    std::mutex               m_Mutex; // guards m_Phases
+
+public:
+    class Scope {
+        TimeReport*       m_Report;
+        std::string_view  m_Name;
+        Clock::time_point m_Start;
+        uint64_t          m_Allocations;
+        uint64_t          m_AllocBytes;
+
+    public:
+        Scope(TimeReport* _report, std::string_view _name);
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() { end(); }
+
+        /** @brief ends the phase before the scope does, later calls do nothing */
+        void end();
+    };
+
+    void enable() { m_Enabled = true; }
+    bool enabled() const { return m_Enabled; }
+
+    /** @brief starts measuring the phase `_name` (which must outlive the scope) */
+    Scope phase(std::string_view _name) { return {m_Enabled ? this : nullptr, _name}; }
+
+    const std::vector<PhaseRecord>& phases() const { return m_Phases; }
+
+    /**
+     * @brief prints the phases as a table
+     *
+     * Phases on different threads overlap, so the total is not their sum: it is the wall time from the
+     * start of the first phase to the end of the last, and the allocations since the report was created.
+     */
+    void print(std::ostream& _out) const;
+
+    /** @brief writes the phases to `_path` as Chrome trace events (chrome://tracing, Perfetto) */
+    bool writeTrace(const std::string& _path) const;
+};
+
+#endif
@@ -2,19 +2,170 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <cstdio>
+#include <string_view>
+
+#include <swirl.typedefs/swirl_t.h>
 
 #ifndef UTILS_H_Swirl
 #define UTILS_H_Swirl
 
-#define LOG(x) if (_debug) std::cout << "[DEBUG] " << "[" << __builtin_FUNCTION() << "]\t" << x << std::endl;
+#define LOG_TO(_stream, x) if (_debug) _stream << "[DEBUG] " << "[" << __builtin_FUNCTION() << "]\t" << x << std::endl;
+#define LOG(x) LOG_TO(std::cout, x)
+
+/**
+ * @brief Reads a file one line at a time through a fixed-size buffer
+ *
+ * Lines are handed out as views into the buffer (without the newline), each one is valid until
+ * the next is read. Memory use only depends on the buffer size and the longest line, the buffer
+ * grows to fit a line that does not fit, never the file.
+ */
+class LineReader
+{
+    std::FILE*        m_File = nullptr;
+    std::vector<char> m_Buffer;
+    std::size_t       m_Begin = 0; // unread bytes are [m_Begin, m_End)
+    std::size_t       m_End   = 0;
+
+public:
+    class iterator
+    {
+        LineReader*      m_Reader;
+        std::string_view m_Line;
+
+    public:
+        using value_type = std::string_view;
+
+        explicit iterator(LineReader* _reader) : m_Reader(_reader) { ++*this; }
+        iterator() : m_Reader(nullptr) {}
+
+        std::string_view operator*() const { return m_Line; }
+        iterator& operator++() { if (!m_Reader->next(m_Line)) m_Reader = nullptr; return *this; }
+        bool operator!=(const iterator& _other) const { return m_Reader != _other.m_Reader; }
+        bool operator==(const iterator& _other) const { return m_Reader == _other.m_Reader; }
+    };
+
+    explicit LineReader(const std::string& _path, std::size_t _bufferSize = 1 << 16);
+    LineReader(LineReader&& _other) noexcept;
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+    ~LineReader();
+
+    bool isOpen() const { return m_File != nullptr; }
+
+    /** @brief reads the next line into `_line`, returns false at the end of the file */
+    bool next(std::string_view& _line);
+
+    /** @brief single pass, iterating again continues where the last iteration stopped */
+    iterator begin() { return iterator(this); }
+    iterator end() { return {}; }
+};
+
+/**
+ * @brief A file kept open for writing, with a user-space buffer in front of it
+ *
+ * Small writes are collected in the buffer, a write that does not fit goes out together with the
+ * buffered bytes in a single writev. Nothing reaches the file before flush(), close() or the buffer
+ * filling up. The writer closes (and flushes) itself on destruction.
+ */
+class FileWriter
+{
+public:
+    enum Flags : unsigned {
+        TRUNCATE = 0,
+        APPEND   = 1 << 0,
+        SYNC     = 1 << 1, // fsync on every flush()
+        DIRECT   = 1 << 2, // bypass the page cache (O_DIRECT) where the file system allows it
+    };
+
+private:
+    static constexpr std::size_t ALIGNMENT = 4096;
+
+    int         m_Fd     = -1;
+    std::FILE*  m_File   = nullptr; // used instead of m_Fd where there is no POSIX IO
+    unsigned    m_Flags  = TRUNCATE;
+    char*       m_Buffer = nullptr;
+    std::size_t m_Capacity = 0;
+    std::size_t m_Size     = 0;
+    bool        m_Failed   = false;
+
+    /** @brief writes all of `_pieces`, resuming after short writes */
+    bool writeAll(std::string_view _first, std::string_view _second = {});
+
+    /** @brief writes the buffered bytes, with DIRECT only the whole blocks unless `_all` */
+    bool drain(bool _all);
+
+public:
+    explicit FileWriter(const std::string& _path, unsigned _flags = TRUNCATE, std::size_t _bufferSize = 1 << 16);
+    FileWriter(FileWriter&& _other) noexcept;
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+    ~FileWriter() { close(); }
+
+    bool isOpen() const { return m_Fd != -1 || m_File; }
+
+    /** @brief false once any write to the file has failed */
+    bool good() const { return isOpen() && !m_Failed; }
+
+    bool write(std::string_view _data);
+
+    /** @brief hands the buffered bytes to the OS, and to the disk with SYNC */
+    bool flush();
+
+    /** @brief flushes and closes the file, further writes fail */
+    bool close();
+};
 
 struct F_IO_Object
 {
-    class R_ModeObject;
+    class R_ModeObject
+    {
+    private:
+        std::string filePath;
+
+    public:
+        R_ModeObject(Swirl::string filePath) : filePath(filePath.__to_cpp_str__()) {}
+
+        Swirl::string read();
+
+        /** @brief a lazy range over the lines of the file, which is read as the range is iterated */
+        LineReader readlines() { return LineReader(filePath); }
+    };
+
+    /* Truncates the file when opened, writes are buffered until flush() or close(). */
+    class W_ModeObject
+    {
+    private:
+        std::string filePath;
+        FileWriter  w_buf;
+
+    public:
+        W_ModeObject(Swirl::string filePath, unsigned flags = FileWriter::TRUNCATE)
+            : filePath(filePath.__to_cpp_str__()), w_buf(this->filePath, flags) {}
+
+        /** @brief writes the first `streamCount` bytes of `str`, all of it when 0 */
+        bool write(const Swirl::string& str, int streamCount = 0);
+        bool flush() { return w_buf.flush(); }
+        bool close() { return w_buf.close(); }
+    };
+
+    /* Appends to the file, reads see everything written before them. */
+    class DualModeObject
+    {
+    private:
+        std::string filePath;
+        FileWriter  w_buf;
 
-    class W_ModeObject;
+    public:
+        DualModeObject(Swirl::string filePath, unsigned flags = FileWriter::APPEND)
+            : filePath(filePath.__to_cpp_str__()), w_buf(this->filePath, flags | FileWriter::APPEND) {}
 
-    class DualModeObject;
+        bool write(const Swirl::string& str, int streamCount = 0);
+        Swirl::string read();
+        LineReader readlines() { w_buf.flush(); return LineReader(filePath); }
+        bool flush() { return w_buf.flush(); }
+        bool close() { return w_buf.close(); }
+    };
 };
 
 #if defined(_WIN32)
@@ -0,0 +1,167 @@
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+#include <condition_variable>
+
+#include <build/scheduler.h>
+#include <tokenizer/SourceFile.h>
+#include <tokenizer/Tokenizer.h>
+
+std::vector<std::string> collectSources(const std::vector<std::string>& _inputs) {
+    std::vector<std::string> sources;
+
+    for (const std::string& input : _inputs) {
+        if (!std::filesystem::is_directory(input)) {
+            sources.push_back(input);
+            continue;
+        }
+
+        std::vector<std::string> found;
+        auto it = std::filesystem::recursive_directory_iterator(input);
+        for (; it != std::filesystem::recursive_directory_iterator(); ++it) {
+            if (it->is_directory() && it->path().filename() == "__swirl_cache__") {
+                it.disable_recursion_pending();
+                continue;
+            }
+            if (it->is_regular_file() && it->path().extension() == ".sw")
+                found.push_back(it->path().string());
+        }
+
+        // directory iteration order is unspecified, keep builds reproducible
+        std::sort(found.begin(), found.end());
+        sources.insert(sources.end(), found.begin(), found.end());
+    }
+
+    return sources;
+}
+
+std::vector<std::string> scanImports(std::string_view _source) {
+    std::vector<std::string> imports;
+    Interner symbols;
+    InputStream is(_source);
+    TokenStream tk(is, symbols);
+
+    for (Token tok = tk.next(); tok.type != NONE; tok = tk.next()) {
+        if (tok.keyword != KW_FROM) continue;
+
+        std::string module;
+        while ((tok = tk.next()).type != NONE && tok.keyword != KW_IMPORT)
+            module += tok.value;
+        imports.push_back(module);
+    }
+
+    return imports;
+}
+
+/** @brief whether `_source` is the file `_module` (a dotted module path) refers to */
+static bool providesModule(const std::string& _source, std::string _module) {
+    std::replace(_module.begin(), _module.end(), '.', '/');
+    std::string stem = std::filesystem::path(_source).replace_extension().generic_string();
+
+    if (!stem.ends_with(_module)) return false;
+    return stem.size() == _module.size() || stem[stem.size() - _module.size() - 1] == '/';
+}
+
+std::vector<BuildJob> planBuild(const std::vector<std::string>& _sources) {
+    std::vector<BuildJob> jobs;
+    for (const std::string& source : _sources)
+        jobs.push_back({.source = source});
+
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        SourceFile file(jobs[i].source);
+
+        for (const std::string& module : scanImports(file.view())) {
+            for (std::size_t dep = 0; dep < jobs.size(); dep++) {
+                if (dep == i || !providesModule(jobs[dep].source, module)) continue;
+                if (std::find(jobs[i].deps.begin(), jobs[i].deps.end(), dep) != jobs[i].deps.end()) continue;
+
+                jobs[i].deps.push_back(dep);
+                jobs[dep].dependents.push_back(i);
+            }
+        }
+    }
+
+    return jobs;
+}
+
+bool runJobs(const std::vector<BuildJob>& _jobs, unsigned _workers, const std::function<bool(const BuildJob&)>& _run,
+             std::ostream& _err) {
+    std::vector<std::size_t> pending(_jobs.size());
+    std::vector<bool>        blocked(_jobs.size(), false);
+    std::deque<std::size_t>  ready;
+
+    for (std::size_t i = 0; i < _jobs.size(); i++) {
+        pending[i] = _jobs[i].deps.size();
+        if (!pending[i]) ready.push_back(i);
+    }
+
+    // Kahn's algorithm on a copy, every job has to be reachable or the imports are cyclic
+    {
+        std::vector<std::size_t> indegree = pending;
+        std::deque<std::size_t>  order = ready;
+        std::size_t visited = 0;
+
+        while (!order.empty()) {
+            std::size_t job = order.front();
+            order.pop_front();
+            visited++;
+            for (std::size_t dependent : _jobs[job].dependents)
+                if (!--indegree[dependent]) order.push_back(dependent);
+        }
+
+        if (visited != _jobs.size()) {
+            _err << "Cyclic imports between:\n";
+            for (std::size_t i = 0; i < _jobs.size(); i++)
+                if (indegree[i]) _err << "    " << _jobs[i].source << "\n";
+            return false;
+        }
+    }
+
+    std::mutex              mtx;
+    std::condition_variable cv;
+    std::size_t             remaining = _jobs.size();
+    bool                    success   = true;
+    std::vector<std::size_t> skipped;
+
+    auto worker = [&] {
+        std::unique_lock lock(mtx);
+
+        while (true) {
+            cv.wait(lock, [&] { return !ready.empty() || !remaining; });
+            if (!remaining) return;
+
+            std::size_t job = ready.front();
+            ready.pop_front();
+
+            bool ok = false;
+            if (!blocked[job]) {
+                lock.unlock();
+                ok = _run(_jobs[job]);
+                lock.lock();
+                success &= ok;
+            } else skipped.push_back(job);
+
+            for (std::size_t dependent : _jobs[job].dependents) {
+                if (!ok) blocked[dependent] = true;
+                if (!--pending[dependent]) ready.push_back(dependent);
+            }
+
+            remaining--;
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    _workers = std::max(1u, std::min<unsigned>(_workers, _jobs.size()));
+    for (unsigned i = 0; i < _workers; i++)
+        pool.emplace_back(worker);
+    for (std::thread& thread : pool)
+        thread.join();
+
+    // reported once the workers are done, `_run` may be writing to `_err` until then
+    for (std::size_t job : skipped)
+        _err << "Skipping '" << _jobs[job].source << "', a module it imports failed to build\n";
+    return success;
+}
@@ -0,0 +1,131 @@
+#include <random>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <cache/cache.h>
+#include <process/process.h>
+
+std::string hashContent(std::string_view _data) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char chr : _data) {
+        hash ^= static_cast<unsigned char>(chr);
+        hash *= 0x100000001b3ULL;
+    }
+
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string ret(16, '0');
+    for (int i = 15; i >= 0; i--, hash >>= 4)
+        ret[i] = digits[hash & 0xF];
+    return ret;
+}
+
+/** @brief a name next to `_path` to build the file under, unique so concurrent builds don't share it */
+static std::string tempPath(const std::string& _path) {
+    return _path + ".tmp" + std::to_string(std::random_device{}());
+}
+
+/**
+ * @brief Replaces the file at `_path` with `_content` in one step
+ *
+ * Other builds sharing the cache directory see either the old file or the new one, never a half-written one.
+ */
+static bool writeAtomically(const std::string& _path, std::string_view _content) {
+    std::string tmp = tempPath(_path);
+    std::ofstream buf(tmp, std::ios::binary);
+    buf.write(_content.data(), static_cast<std::streamsize>(_content.size()));
+    buf.close();
+
+    std::error_code ec;
+    if (buf) std::filesystem::rename(tmp, _path, ec);
+    bool ok = buf && !ec;
+    if (!ok) std::filesystem::remove(tmp, ec);
+    return ok;
+}
+
+/** @brief whether `_cxx` is clang, also behind names like `c++` or `cc` */
+static bool isClang(const std::vector<std::string>& _cxx) {
+    std::vector<std::string> version_cmd = _cxx;
+    version_cmd.emplace_back("--version");
+    return runProcess(version_cmd, true).output.find("clang") != std::string::npos;
+}
+
+std::vector<std::string> precompilePrelude(const std::string& _header, const std::vector<std::string>& _cxx,
+                                           std::string_view _prelude) {
+    // the stamp records what the precompiled header was built from, then the outcome:
+    // "clang" or "gcc" for a usable header, "failed" when this compiler couldn't precompile it
+    std::string stamp_path = _header + ".stamp";
+    std::string stamp = hashContent(_prelude) + " " + joinCommand(_cxx);
+
+    std::ifstream stamp_buf(stamp_path);
+    std::string cur_stamp, outcome;
+    std::getline(stamp_buf, cur_stamp);
+    std::getline(stamp_buf, outcome);
+    stamp_buf.close();
+
+    auto flags_for = [&_header](bool _clang) -> std::vector<std::string> {
+        if (_clang) return {"-include-pch", _header + ".pch"};
+        return {};
+    };
+
+    if (cur_stamp == stamp && std::filesystem::exists(_header)) {
+        // a failed precompile is not retried until the prelude or the compiler changes
+        if (outcome == "failed") return {};
+
+        bool clang = outcome == "clang";
+        if ((clang || outcome == "gcc") && std::filesystem::exists(_header + (clang ? ".pch" : ".gch")))
+            return flags_for(clang);
+    }
+
+    bool clang = isClang(_cxx);
+    std::string pch = _header + (clang ? ".pch" : ".gch");
+
+    writeAtomically(_header, _prelude);
+
+    std::string pch_tmp = tempPath(pch);
+    std::vector<std::string> pch_cmd = _cxx;
+    pch_cmd.insert(pch_cmd.end(), {"-x", "c++-header", _header, "-o", pch_tmp});
+
+    // a failed precompile is not an error, its diagnostics would show up again in the real compile
+    std::error_code ec;
+    if (!runProcess(pch_cmd).ok()) {
+        std::filesystem::remove(pch_tmp, ec);
+        std::filesystem::remove(pch, ec);
+        writeAtomically(stamp_path, stamp + "\nfailed\n");
+        return {};
+    }
+
+    std::filesystem::rename(pch_tmp, pch, ec);
+    if (ec) {
+        std::filesystem::remove(pch_tmp, ec);
+        return {};
+    }
+
+    writeAtomically(stamp_path, stamp + '\n' + (clang ? "clang" : "gcc") + '\n');
+    return flags_for(clang);
+}
+
+std::optional<BuildManifest> BuildManifest::load(const std::string& _path) {
+    std::ifstream manifest_buf(_path);
+    if (!manifest_buf) return {};
+
+    BuildManifest ret;
+    for (std::string line; std::getline(manifest_buf, line); ) {
+        std::size_t sep = line.find('=');
+        if (sep == std::string::npos) return {};
+
+        std::string key = line.substr(0, sep);
+        std::string val = line.substr(sep + 1);
+        if      (key == "source_hash") ret.source_hash = val;
+        else if (key == "compiler")    ret.compiler    = val;
+        else if (key == "command")     ret.command     = val;
+        else if (key == "version")     ret.version     = val;
+    }
+    return ret;
+}
+
+bool BuildManifest::save(const std::string& _path) const {
+    return writeAtomically(_path, "source_hash=" + source_hash + '\n'
+                                  + "compiler="  + compiler    + '\n'
+                                  + "command="   + command     + '\n'
+                                  + "version="   + version     + '\n');
+}
@@ -35,19 +35,23 @@ std::string cli::generate_help() {
 }
 
 std::optional<std::string> cli::get_file() {
+	std::vector<std::string> files = get_files();
+	if (files.empty()) return {};
+	return files.front();
+}
+
+std::vector<std::string> cli::get_files() {
+	std::vector<std::string> files;
 	for (int i = 1; i < m_argc; i++) {
-		if (
-			m_argv[i][0] != '-' &&
-			(m_argv[i - 1][0] != '-' ||
-			std::find_if(m_flags -> begin(), m_flags -> end(), [&](const Argument& _arg) {
-				if (_arg.value_required) return false;
-				auto &[v1, v2] = _arg.flags;
-				return v1 == m_argv[i - 1] || v2 == m_argv[i - 1];
-			}) != m_flags -> end()
-		)) {
-			return m_argv[i];
-		}
-	} return {};
+		if (m_argv[i][0] != '-') { files.push_back(m_argv[i]); continue; }
+
+		// the value of a flag is not a file, the same as parse() sees it
+		auto it = std::find_if(m_flags -> cbegin(), m_flags -> cend(), [&](const Argument& _arg) {
+			auto &[v1, v2] = _arg.flags;
+			return v1 == m_argv[i] || v2 == m_argv[i];
+		});
+		if (it != m_flags -> cend() && it->value_required) i++;
+	} return files;
 }
 
 std::vector<Argument> cli::parse() {
@@ -64,14 +68,15 @@ std::vector<Argument> cli::parse() {
 				return v1 == *arg_iterator || v2 == *arg_iterator;
 			});
 
-			if (it == m_flags -> cend()) { std::cerr << "Unknown flag: " << *arg_iterator << '\n'; exit(1); }
+			if (it == m_flags -> cend()) { m_error = "Unknown flag: " + std::string(*arg_iterator); break; }
 
 			if (!it->value_required) supplied.push_back(*it);
 			else {
-				if (arg_iterator + 1 == args.cend()) { std::cout << "Value missing for the flag: " << *arg_iterator << '\n'; exit(1); }
+				if (arg_iterator + 1 == args.cend()) { m_error = "Value missing for the flag: " + std::string(*arg_iterator); break; }
 
+				// the value is taken as it is, even if it starts with `-`
 				Argument _arg = *it;
-				_arg.value = *(arg_iterator + 1);
+				_arg.value = *++arg_iterator;
 				supplied.push_back(_arg);
 			}
 
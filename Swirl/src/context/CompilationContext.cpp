@@ -0,0 +1,6 @@
+#include <context/CompilationContext.h>
+
+CompilationContext::CompilationContext(std::string_view _source) : source(_source) {
+    for (std::string_view type : {"int", "string", "bool", "float", "var", "function"})
+        type_registry[symbols.intern(type)] = "global";
+}
@@ -1,15 +1,25 @@
 #include <iostream>
-#include <map>
-#include <sstream>
-
-extern std::string SW_FED_FILE_SOURCE;
-
-void raiseException(const char* _msg, std::map<const char*, std::size_t> _prsState) {
-    std::stringstream src_stream(SW_FED_FILE_SOURCE);
-    std::size_t cl_index;
-    for (std::string cur_ln; std::getline(src_stream, cur_ln); cl_index++) {
-        if (cl_index == _prsState["LINE"]) {
-            std::cout << cur_ln << std::endl;
-        }
-    }
-}
\ No newline at end of file
+#include <string>
+#include <algorithm>
+
+#include <exception/exception.h>
+
+std::string formatDiagnostic(std::string_view _source, Diagnostic& _diag) {
+    LineIndex line_index(_source);
+    auto [line, col] = line_index.locate(_diag.span.offset);
+    std::string_view src_line = line_index.line(line);
+    _diag.line   = line;
+    _diag.column = col + 1;
+
+    // underline the span, up to the end of its first line
+    std::size_t width = std::min<std::size_t>(_diag.span.length, src_line.size() - col);
+
+    return "Error at line " + std::to_string(line) + ", column " + std::to_string(col + 1) + ": " + _diag.message + '\n'
+           + std::string(src_line) + '\n'
+           + std::string(col, ' ') + '^' + std::string(width > 1 ? width - 1 : 0, '~');
+}
+
+void raiseException(std::string_view _source, const char* _msg, SourceSpan _span) {
+    Diagnostic diag{.message = _msg, .span = _span};
+    std::cerr << formatDiagnostic(_source, diag) << std::endl;
+}
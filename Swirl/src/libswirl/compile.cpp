@@ -0,0 +1,46 @@
+#include <exception>
+
+#include <libswirl/swirl.h>
+#include <context/CompilationContext.h>
+#include <tokenizer/InputStream.h>
+#include <tokenizer/Tokenizer.h>
+#include <transpiler/transpiler.h>
+#include <parser/parser.h>
+
+Swirl::Result Swirl::compile(std::string_view _source, const Options& _opts) {
+    Result res;
+    TimeReport report;
+    if (_opts.timings) report.enable();
+
+    // the tokenizer reads one byte past the source and expects it to end with a newline,
+    // which SourceFile guarantees for files; give the caller's view the same guarantee
+    std::string source(_source);
+    if (source.empty() || source.back() != '\n') source += '\n';
+
+    CompilationContext ctx(source);
+    if (_opts.inline_prelude) ctx.output.prelude = RUNTIME_PRELUDE;
+
+    try {
+        auto parse_phase = report.phase("parse");
+        InputStream is(source);
+        TokenStream tk(is, ctx.symbols);
+        Parser parser(tk, ctx);
+        parser.dispatch();
+        parse_phase.end();
+
+        auto transpile_phase = report.phase("transpile");
+        Transpile(ctx, *parser.m_AST, parser.m_AST->chl, "", ctx.output.main);
+        res.cpp_text = ctx.output.str();
+    } catch (const std::exception& _err) {
+        // the front end has few checks of its own, malformed input can still trip the library
+        ctx.error(std::string("internal error: ") + _err.what());
+    }
+
+    for (Diagnostic& diag : ctx.diagnostics)
+        formatDiagnostic(source, diag);
+
+    res.success     = ctx.diagnostics.empty();
+    res.diagnostics = std::move(ctx.diagnostics);
+    res.timings     = report.phases();
+    return res;
+}
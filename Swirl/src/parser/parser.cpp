@@ -5,37 +5,43 @@
 
 #include <unordered_map>
 #include <parser/parser.h>
+#include <context/CompilationContext.h>
 #include <exception/exception.h>
-#include <list>
 
 using namespace std::string_literals;
 
 
-// Flags
-short      ang_ind      = 0;
-uint8_t    is_first_t   = 1;
-uint8_t    rd_param     = 0;
-uint8_t    rd_func      = 0;
-uint8_t    rd_param_cnt = 0;
+NodeIndex AbstractSyntaxTree::append(const Node& _node, NodeIndex _parent, NodeList Node::* _list) {
+    auto index = static_cast<NodeIndex>(m_Nodes.size());
+    m_Nodes.push_back(_node);
+    m_Nodes.back().next = NO_NODE;
 
-extern std::unordered_map<std::string, const char* > type_registry;
+    NodeList& list = _parent == NO_NODE ? chl : m_Nodes[_parent].*_list;
+    if (list.empty()) list.first = index;
+    else m_Nodes[list.last].next = index;
+    list.last = index;
+    return index;
+}
 
-void Parser::appendAST(Node& node) {
-    auto state = m_Stream.getStreamState();
-    node.loc["col"] = state["col"];
-    node.loc["line"] = state["line"];
+NodeIndex Parser::appendAST(Node& node) {
+    NodeIndex index;
 
-    if (rd_param) m_AST->chl.back().arg_nodes.push_back(node);
+    if (rd_param) index = m_AST->append(node, m_AST->chl.last, &Node::arg_nodes);
     else if (ang_ind > 0) {
-        m_AST->chl.back().template_args.push_back(node);
         if (node.type == IDENT)
-            type_registry[node.value] = "template";
+            m_Ctx.type_registry[node.symbol] = "template";
+        index = m_AST->append(node, m_AST->chl.last, &Node::template_args);
     }
-    else if (!rd_param && rd_func)  m_AST->chl.back().body.push_back(node);
-    else { m_AST->chl.push_back(node); }
+    else if (rd_func) index = m_AST->append(node, m_AST->chl.last, &Node::body);
+    else index = m_AST->append(node);
+
+    // nodes that don't cover a range of their own are located at the token being read
+    Node& appended = (*m_AST)[index];
+    if (!appended.span.length) appended.span = cur_rd_tok.span;
+    return index;
 }
 
-Parser::Parser(TokenStream& _stream) : m_Stream(_stream) {
+Parser::Parser(TokenStream& _stream, CompilationContext& _ctx) : m_Ctx(_ctx), m_Stream(_stream) {
     m_AST = new AbstractSyntaxTree{};
 }
 
@@ -50,8 +56,10 @@ void Parser::next(bool swsFlg, bool snsFlg) {
 void Parser::dispatch() {
     int         br_ind    = 0;
     int         prn_ind   = 0;
-    const char* tmp_ident = "";
-    const char* tmp_type  = "";
+    std::string_view tmp_ident;
+    SymbolId         tmp_symbol = NO_SYMBOL;
+    SourceSpan       tmp_span{};
+    std::string_view tmp_type;
 
     Node tmp_node{};
 
@@ -59,7 +67,7 @@ void Parser::dispatch() {
 
     while (cur_rd_tok.type != NONE) {
         TokenType t_type = cur_rd_tok.type;
-        std::string t_val(cur_rd_tok.value);
+        std::string_view t_val = cur_rd_tok.value;
 
         if (t_type == PUNC) {
             if (rd_func) {
@@ -75,7 +83,7 @@ void Parser::dispatch() {
                         next();
                         if (cur_rd_tok.type == PUNC && cur_rd_tok.value == ":") {
                             next();
-                            m_AST->chl.back().ctx_type = cur_rd_tok.value;
+                            m_AST->back(m_AST->chl).ctx_type = cur_rd_tok.value;
                             next();
                             continue;
                         } continue;
@@ -88,7 +96,7 @@ void Parser::dispatch() {
                     if (br_ind == 0) {
                         rd_func = false;
                         tmp_node.type = BR_CLOSE;
-                        m_AST->chl.back().body.push_back(tmp_node);
+                        m_AST->append(tmp_node, m_AST->chl.last, &Node::body);
                         tmp_node.type = _NONE;
                         rd_param = false;
                         rd_param_cnt = 0;
@@ -113,69 +121,87 @@ void Parser::dispatch() {
         }
 
         if (t_type == KEYWORD) {
-            if (t_val == "if") {
-                parseCondition(IF);
-                cur_rd_tok = m_Stream.p_CurTk;
-                continue;
-            } else if (t_val == "elif") {
-                parseCondition(ELIF);
-                cur_rd_tok = m_Stream.p_CurTk;
-                continue;
-            } else if (t_val == "else") {
-                parseCondition(ELSE);
-                cur_rd_tok = m_Stream.p_CurTk;
-                continue;
-            } else if (t_val == "while") {
-                parseLoop(WHILE);
-                cur_rd_tok = m_Stream.p_CurTk;
-                continue;
-            } else if (t_val == "for") {
-                parseLoop(FOR);
-                cur_rd_tok = m_Stream.p_CurTk;
-                continue;
-            } else if (t_val == "func") {
-                parseFunction();
-                rd_func = true;
-                continue;
-            } else if (t_val == "from") {
-                tmp_node.type = IMPORT;
-
-                while (m_Stream.next().value != "import")
-                    tmp_node.from += m_Stream.p_CurTk.value;
-
-                while (m_Stream.next(true).value != "\n")
-                    tmp_node.impr += m_Stream.p_CurTk.value;
-
-                appendAST(tmp_node);
-
-                tmp_node.type = _NONE;
-                tmp_node.from = tmp_node.impr = "";
-
-                next();
-                continue;
-            } else if (t_val == "export") {
-                tmp_node.type = EXPORT;
-                while (m_Stream.next(true).value != "\n")
-                    if (m_Stream.p_CurTk.type == IDENT)
-                        tmp_node.body.push_back(Node { .value = m_Stream.p_CurTk.value.data() });
-                appendAST(tmp_node);
-                tmp_node.type = _NONE;
-                next();
-                continue;
-            } else if (t_val == "typedef") {
-                tmp_node.type = TYPEDEF;
-                tmp_node.ident = m_Stream.next().value;
-
-                type_registry[m_Stream.p_CurTk.value.data()] = "";
-                while (m_Stream.next(true, true).value != "\n")
-                    tmp_node.value += m_Stream.p_CurTk.value;
-
-                appendAST(tmp_node);
-                tmp_node.type = _NONE;
-                tmp_node.value = "";
-                tmp_node.ident = "";
-                next();
-                continue;
+            switch (cur_rd_tok.keyword) {
+                case KW_IF:
+                    parseCondition(IF);
+                    cur_rd_tok = m_Stream.p_CurTk;
+                    continue;
+                case KW_ELIF:
+                    parseCondition(ELIF);
+                    cur_rd_tok = m_Stream.p_CurTk;
+                    continue;
+                case KW_ELSE:
+                    parseCondition(ELSE);
+                    cur_rd_tok = m_Stream.p_CurTk;
+                    continue;
+                case KW_WHILE:
+                    parseLoop(WHILE);
+                    cur_rd_tok = m_Stream.p_CurTk;
+                    continue;
+                case KW_FOR:
+                    parseLoop(FOR);
+                    cur_rd_tok = m_Stream.p_CurTk;
+                    continue;
+                case KW_FUNC:
+                    parseFunction();
+                    rd_func = true;
+                    continue;
+                case KW_FROM: {
+                    std::string from, impr;
+                    tmp_node.type = IMPORT;
+
+                    while (m_Stream.next().keyword != KW_IMPORT)
+                        from += m_Stream.p_CurTk.value;
+
+                    while (m_Stream.next(true).value != "\n")
+                        impr += m_Stream.p_CurTk.value;
+
+                    tmp_node.from = m_AST->store(from);
+                    tmp_node.impr = m_AST->store(impr);
+                    appendAST(tmp_node);
+
+                    tmp_node.type = _NONE;
+                    tmp_node.from = tmp_node.impr = "";
+
+                    next();
+                    continue;
+                }
+                case KW_EXPORT: {
+                    std::vector<std::string_view> exports;
+                    tmp_node.type = EXPORT;
+                    while (m_Stream.next(true).value != "\n")
+                        if (m_Stream.p_CurTk.type == IDENT)
+                            exports.push_back(m_Stream.p_CurTk.value);
+
+                    NodeIndex exp_node = appendAST(tmp_node);
+                    for (std::string_view exp : exports) {
+                        Node exp_name{};
+                        exp_name.value = exp;
+                        m_AST->append(exp_name, exp_node, &Node::body);
+                    }
+                    tmp_node.type = _NONE;
+                    next();
+                    continue;
+                }
+                case KW_TYPEDEF: {
+                    std::string type;
+                    tmp_node.type = TYPEDEF;
+                    tmp_node.ident = m_Stream.next().value;
+
+                    m_Ctx.type_registry[m_Ctx.symbols.intern(m_Stream.p_CurTk.value)] = "";
+                    while (m_Stream.next(true, true).value != "\n")
+                        type += m_Stream.p_CurTk.value;
+
+                    tmp_node.value = m_AST->store(type);
+                    appendAST(tmp_node);
+                    tmp_node.type = _NONE;
+                    tmp_node.value = "";
+                    tmp_node.ident = "";
+                    next();
+                    continue;
+                }
+                default:
+                    break;
             }
 
             tmp_node.type = KEYWORD;
@@ -188,8 +214,10 @@ void Parser::dispatch() {
         }
 
         if (t_type == IDENT) {
-            tmp_ident = t_val.c_str();
-            if (strcmp(tmp_type, "") != 0) {
+            tmp_ident  = t_val;
+            tmp_symbol = cur_rd_tok.symbol;
+            tmp_span   = cur_rd_tok.span;
+            if (!tmp_type.empty()) {
                 parseDecl(tmp_type, tmp_ident);
                 tmp_type = "";
                 tmp_ident = "";
@@ -199,22 +227,33 @@ void Parser::dispatch() {
 
             next();
             if (m_Stream.p_CurTk.value == "(") {
-                parseCall(tmp_ident);
+                parseCall(tmp_ident, tmp_span);
                 continue;
             }
 
             tmp_node.type = IDENT;
             tmp_node.value = tmp_ident;
+            tmp_node.symbol = tmp_symbol;
+            tmp_node.span = tmp_span;
             appendAST(tmp_node);
             tmp_node.type = _NONE;
             tmp_node.value = "";
+            tmp_node.symbol = NO_SYMBOL;
+            tmp_node.span = {};
             continue;
         }
 
         if (t_type == STRING) {
             if (t_val.starts_with("f")) {
                 tmp_node.format = true;
-                t_val.erase(0, 1);
+                t_val.remove_prefix(1);
+            }
+
+            if (t_val.starts_with('\'')) {
+                std::string quoted(t_val);
+                quoted.front() = '"';
+                quoted.back()  = '"';
+                t_val = m_AST->store(quoted);
             }
 
             tmp_node.type = t_type;
@@ -277,14 +316,16 @@ void Parser::parseFunction() {
     Node func_node{};
     func_node.type = FUNCTION;
     func_node.ctx_type = "auto";
+    func_node.span = cur_rd_tok.span;
     next();
     func_node.ident = cur_rd_tok.value;
+    func_node.span.length = cur_rd_tok.span.offset + cur_rd_tok.span.length - func_node.span.offset;
 
     next();
     appendAST(func_node);
 }
 
-void Parser::parseDecl(const char* _type, const char* _ident) {
+void Parser::parseDecl(std::string_view _type, std::string_view _ident) {
     Node decl_node{};
     decl_node.type = VAR;
     decl_node.ctx_type = _type;
@@ -299,11 +340,11 @@ void Parser::parseDecl(const char* _type, const char* _ident) {
     appendAST(decl_node);
 }
 
-void Parser::parseCall(const char* _ident) {
+void Parser::parseCall(std::string_view _ident, SourceSpan _span) {
     Node call_node{};
-    Node arg_node{};
     call_node.type = CALL;
     call_node.ident = _ident;
+    call_node.span = _span;
 
 //    m_Stream.next();
 //    if (m_AST->chl[-1].type == "FUNCTION" && m_AST->chl[-1].body[-1].ident == _ident)
@@ -311,32 +352,107 @@ void Parser::parseCall(const char* _ident) {
     appendAST(call_node);
 }
 
+/** @brief joins the values of `_tokens` with spaces, the way loop and branch conditions are stored */
+static std::string joinTokens(const std::vector<Token>& _tokens, std::size_t _begin, std::size_t _end) {
+    std::string ret;
+    for (std::size_t i = _begin; i < _end; i++) {
+        ret += _tokens[i].value;
+        ret += ' ';
+    }
+    return ret;
+}
+
+/**
+ * @brief finds the bounds of a numeric range, `range(end)`, `range(begin, end[, step])` or `begin..end`
+ * @return the tokens of each bound as [begin, end) pairs, nothing if `_tokens` is some other iterable
+ */
+static std::vector<std::pair<std::size_t, std::size_t>> rangeBounds(const std::vector<Token>& _tokens, std::size_t _begin) {
+    std::vector<std::pair<std::size_t, std::size_t>> bounds;
+    std::size_t end = _tokens.size();
+    int depth = 0;
+
+    if (end - _begin >= 3 && _tokens[_begin].value == "range" && _tokens[_begin + 1].value == "("
+        && _tokens[end - 1].value == ")") {
+        std::size_t arg_begin = _begin + 2;
+        for (std::size_t i = arg_begin; i < end - 1; i++) {
+            if (_tokens[i].value == "(" || _tokens[i].value == "[") depth++;
+            else if (_tokens[i].value == ")" || _tokens[i].value == "]") depth--;
+            else if (_tokens[i].value == "," && !depth) {
+                bounds.emplace_back(arg_begin, i);
+                arg_begin = i + 1;
+            }
+            // the closing paren has to be the one of range(), not of e.g. `range(1) + f(2)`
+            if (depth < 0) return {};
+        }
+        bounds.emplace_back(arg_begin, end - 1);
+
+        for (auto [b_begin, b_end] : bounds)
+            if (b_begin == b_end) return {};
+        if (bounds.size() > 3) return {};
+        return bounds;
+    }
+
+    for (std::size_t i = _begin; i + 1 < end; i++) {
+        if (_tokens[i].value == "(" || _tokens[i].value == "[") depth++;
+        else if (_tokens[i].value == ")" || _tokens[i].value == "]") depth--;
+        else if (!depth && _tokens[i].value == "." && _tokens[i + 1].value == "."
+                 && _tokens[i].span.offset + 1 == _tokens[i + 1].span.offset) {
+            if (i == _begin || i + 2 == end) return {};
+            return {{_begin, i}, {i + 2, end}};
+        }
+    }
+
+    return {};
+}
+
 void Parser::parseLoop(TokenType _type) {
     Node loop_node{};
+    std::vector<Token> tokens;
     loop_node.type = _type;
+    loop_node.span = cur_rd_tok.span;
 
     next();
     while (m_Stream.p_CurTk.type != NONE) {
         if (m_Stream.p_CurTk.type == PUNC && m_Stream.p_CurTk.value == "{")
             break;
-        loop_node.value += m_Stream.p_CurTk.value.data() + " "s;
+        tokens.push_back(m_Stream.p_CurTk);
+        loop_node.span.length = m_Stream.p_CurTk.span.offset + m_Stream.p_CurTk.span.length - loop_node.span.offset;
         next();
     }
 
-    appendAST(loop_node);
+    // `for <ident> in <iterable>`: the loop variable goes to `ident`, the iterable to `value`
+    // and the bounds of a numeric range to `arg_nodes`, so it can become a counted loop
+    std::vector<std::pair<std::size_t, std::size_t>> bounds;
+    if (_type == FOR && tokens.size() >= 3 && tokens[0].type == IDENT && tokens[1].keyword == KW_IN) {
+        loop_node.ident = tokens[0].value;
+        loop_node.value = m_AST->store(joinTokens(tokens, 2, tokens.size()));
+        bounds = rangeBounds(tokens, 2);
+    } else loop_node.value = m_AST->store(joinTokens(tokens, 0, tokens.size()));
+
+    NodeIndex loop_index = appendAST(loop_node);
+    for (auto [b_begin, b_end] : bounds) {
+        Node bound_node{};
+        bound_node.value = m_AST->store(joinTokens(tokens, b_begin, b_end));
+        m_AST->append(bound_node, loop_index, &Node::arg_nodes);
+    }
 }
 
 void Parser::parseCondition(TokenType _type) {
     Node cnd_node{};
+    std::string condition;
     cnd_node.type = _type;
+    cnd_node.span = cur_rd_tok.span;
 
     next();
     while (m_Stream.p_CurTk.type != NONE) {
         if (m_Stream.p_CurTk.type == PUNC && m_Stream.p_CurTk.value == "{")
             break;
-        cnd_node.value += m_Stream.p_CurTk.value.data() + " "s;
+        condition += m_Stream.p_CurTk.value;
+        condition += ' ';
+        cnd_node.span.length = m_Stream.p_CurTk.span.offset + m_Stream.p_CurTk.span.length - cnd_node.span.offset;
         next();
     }
 
+    cnd_node.value = m_AST->store(condition);
     appendAST(cnd_node);
 }
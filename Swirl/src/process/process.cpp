@@ -0,0 +1,154 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#include <process/process.h>
+
+#if !defined(_WIN32)
+#include <spawn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+#if defined(_WIN32)
+/*
+ * No posix_spawn here, so the command runs through cmd.exe. cmd.exe strips the outermost quotes of a
+ * command line holding more than two, hence the extra pair around the quoted arguments.
+ */
+Process::Process(const std::vector<std::string>& _args, bool) {
+    std::string command = "\"";
+    for (const std::string& arg : _args)
+        command += "\"" + arg + "\" ";
+    command += "2>&1\"";
+
+    m_Pipe = _popen(command.c_str(), "r");
+    if (!m_Pipe) m_Error = "cannot run '" + _args.front() + "': " + strerror(errno) + "\n";
+}
+
+Process::~Process() {
+    if (m_Pipe) wait();
+}
+
+ProcessResult Process::wait() {
+    ProcessResult result;
+
+    if (!m_Pipe) {
+        result.exit_code = 127;
+        result.output = m_Error;
+        return result;
+    }
+
+    char buf[4096];
+    std::size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), m_Pipe)) != 0)
+        result.output.append(buf, n);
+
+    result.exit_code = _pclose(m_Pipe);
+    m_Pipe = nullptr;
+    return result;
+}
+#else
+Process::Process(const std::vector<std::string>& _args, bool _captureStdout) {
+    int fds[2];
+#if defined(__linux__)
+    if (pipe2(fds, O_CLOEXEC) != 0) { m_Error = strerror(errno); return; }
+#else
+    if (pipe(fds) != 0) { m_Error = strerror(errno); return; }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#endif
+
+    // the ends are close-on-exec so processes spawned by other threads don't keep them open
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+    if (_captureStdout)
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+
+    std::vector<char*> argv;
+    for (const std::string& arg : _args)
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    int err = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+
+    if (err != 0) {
+        close(fds[0]);
+        m_Error = "cannot run '" + _args.front() + "': " + strerror(err) + "\n";
+        return;
+    }
+
+    m_Pid  = pid;
+    m_Pipe = fds[0];
+}
+
+Process::~Process() {
+    if (m_Pid != -1) wait();
+}
+
+ProcessResult Process::wait() {
+    ProcessResult result;
+
+    if (m_Pid == -1) {
+        result.exit_code = 127;
+        result.output = m_Error;
+        return result;
+    }
+
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(m_Pipe, buf, sizeof(buf))) != 0) {
+        if (n > 0) result.output.append(buf, n);
+        else if (errno != EINTR) break;
+    }
+    close(m_Pipe);
+
+    int status = 0;
+    pid_t res;
+    while ((res = waitpid(m_Pid, &status, 0)) == -1 && errno == EINTR) {}
+    m_Pid = -1;
+
+    // e.g. ECHILD when SIGCHLD is ignored, the exit status is lost then
+    if (res == -1) {
+        result.output += std::string("waitpid failed: ") + strerror(errno) + "\n";
+        return result;
+    }
+
+    if (WIFEXITED(status)) result.exit_code = WEXITSTATUS(status);
+    else if (WIFSIGNALED(status)) result.exit_code = 128 + WTERMSIG(status);
+    return result;
+}
+#endif
+
+ProcessResult runProcess(const std::vector<std::string>& _args, bool _captureStdout) {
+    return Process(_args, _captureStdout).wait();
+}
+
+std::vector<std::string> splitCommand(std::string_view _command) {
+    std::vector<std::string> args;
+    std::size_t pos = 0;
+
+    while ((pos = _command.find_first_not_of(" \t", pos)) != std::string_view::npos) {
+        std::size_t end = _command.find_first_of(" \t", pos);
+        args.emplace_back(_command.substr(pos, end - pos));
+        pos = end;
+    }
+
+    return args;
+}
+
+std::string joinCommand(const std::vector<std::string>& _args) {
+    std::string command;
+    for (const std::string& arg : _args) {
+        if (!command.empty()) command += ' ';
+        command += arg;
+    }
+    return command;
+}
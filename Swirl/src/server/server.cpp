@@ -0,0 +1,227 @@
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+#include <iostream>
+
+#include <server/server.h>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+
+/** @brief writes all of `_len` bytes, false if the peer went away */
+static bool writeAll(int _fd, const char* _data, std::size_t _len) {
+    while (_len) {
+        ssize_t n = write(_fd, _data, _len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        _data += n;
+        _len  -= n;
+    }
+    return true;
+}
+
+static bool readAll(int _fd, char* _data, std::size_t _len) {
+    while (_len) {
+        ssize_t n = read(_fd, _data, _len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        _data += n;
+        _len  -= n;
+    }
+    return true;
+}
+
+static bool writeU32(int _fd, uint32_t _val) {
+    unsigned char buf[4] = {
+            static_cast<unsigned char>(_val), static_cast<unsigned char>(_val >> 8),
+            static_cast<unsigned char>(_val >> 16), static_cast<unsigned char>(_val >> 24)
+    };
+    return writeAll(_fd, reinterpret_cast<char*>(buf), 4);
+}
+
+static bool readU32(int _fd, uint32_t& _val) {
+    unsigned char buf[4];
+    if (!readAll(_fd, reinterpret_cast<char*>(buf), 4)) return false;
+    _val = buf[0] | buf[1] << 8 | buf[2] << 16 | static_cast<uint32_t>(buf[3]) << 24;
+    return true;
+}
+
+static bool writeString(int _fd, const std::string& _str) {
+    return writeU32(_fd, static_cast<uint32_t>(_str.size())) && writeAll(_fd, _str.data(), _str.size());
+}
+
+static bool readString(int _fd, std::string& _str) {
+    uint32_t len;
+    if (!readU32(_fd, len) || len > (1u << 30)) return false;
+    _str.resize(len);
+    return readAll(_fd, _str.data(), len);
+}
+
+/** @brief fills `_addr` with `_socket`, false if the path does not fit */
+static bool socketAddress(const std::string& _socket, sockaddr_un& _addr) {
+    _addr = {};
+    _addr.sun_family = AF_UNIX;
+    if (_socket.size() >= sizeof(_addr.sun_path)) {
+        std::cerr << "Socket path '" << _socket << "' is too long\n";
+        return false;
+    }
+    std::memcpy(_addr.sun_path, _socket.c_str(), _socket.size() + 1);
+    return true;
+}
+
+/** @brief a close-on-exec socket, so the compilers the server spawns don't inherit it */
+static int openSocket() {
+#if defined(__linux__)
+    return socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+#else
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd != -1) fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+#endif
+}
+
+static int connectTo(const sockaddr_un& _addr) {
+    int fd = openSocket();
+    if (fd == -1) return -1;
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&_addr), sizeof(_addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/** @brief whether the process on the other end of `_fd` runs as the same user as the server */
+static bool sameUser(int _fd) {
+#if defined(__linux__)
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    return getsockopt(_fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == getuid();
+#else
+    uid_t uid;
+    gid_t gid;
+    return getpeereid(_fd, &uid, &gid) == 0 && uid == getuid();
+#endif
+}
+
+std::string defaultSocketPath() {
+    if (const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR"))
+        return std::string(runtime_dir) + "/swirl.sock";
+    return "/tmp/swirl-" + std::to_string(getuid()) + ".sock";
+}
+
+int runServer(const std::string& _socket, const RequestHandler& _handler) {
+    sockaddr_un addr;
+    if (!socketAddress(_socket, addr)) return 1;
+
+    // a socket file nobody answers on is left over from a server that was killed
+    if (int fd = connectTo(addr); fd != -1) {
+        close(fd);
+        std::cerr << "A server is already listening on '" << _socket << "'\n";
+        return 1;
+    }
+    unlink(_socket.c_str());
+
+    // requests run compilers as this user, so only this user may connect
+    int server_fd = openSocket();
+    mode_t old_mask = umask(077);
+    bool bound = server_fd != -1 && bind(server_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    umask(old_mask);
+
+    if (!bound || listen(server_fd, 64) != 0) {
+        std::cerr << "Could not listen on '" << _socket << "': " << strerror(errno) << "\n";
+        return 1;
+    }
+
+    // a client that disconnects early must not take the server down
+    std::signal(SIGPIPE, SIG_IGN);
+    std::cout << "Serving on '" << _socket << "'" << std::endl;
+
+    while (true) {
+        int client = accept(server_fd, nullptr, nullptr);
+        if (client == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            std::cerr << "accept failed: " << strerror(errno) << "\n";
+            break;
+        }
+
+        if (!sameUser(client)) {
+            close(client);
+            continue;
+        }
+
+        // requests are answered one at a time, a client that stops sending or reading must not hold up the others
+        timeval timeout{.tv_sec = 5, .tv_usec = 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        uint32_t count;
+        std::vector<std::string> args;
+        bool ok = readU32(client, count) && count < (1u << 16);
+        for (uint32_t i = 0; ok && i < count; i++)
+            ok = readString(client, args.emplace_back());
+
+        if (ok) {
+            std::ostringstream out;
+            int exit_code = 1;
+            // a request that fails in an unexpected way must not take the other clients' server down
+            try {
+                exit_code = _handler(args, out);
+            } catch (const std::exception& _e) {
+                out << "The server could not handle the request: " << _e.what() << "\n";
+            } catch (...) {
+                out << "The server could not handle the request\n";
+            }
+            writeString(client, out.str()) && writeU32(client, static_cast<uint32_t>(exit_code));
+        }
+        close(client);
+    }
+
+    close(server_fd);
+    unlink(_socket.c_str());
+    return 1;
+}
+
+int requestServer(const std::string& _socket, const std::vector<std::string>& _args) {
+    sockaddr_un addr;
+    if (!socketAddress(_socket, addr)) return -1;
+
+    int fd = connectTo(addr);
+    if (fd == -1) return -1;
+
+    bool ok = writeU32(fd, static_cast<uint32_t>(_args.size()));
+    for (const std::string& arg : _args)
+        ok = ok && writeString(fd, arg);
+
+    std::string output;
+    uint32_t exit_code = 1;
+    ok = ok && readString(fd, output) && readU32(fd, exit_code);
+    close(fd);
+
+    if (!ok) {
+        std::cerr << "The server at '" << _socket << "' closed the connection\n";
+        return 1;
+    }
+
+    std::cerr << output;
+    return static_cast<int>(exit_code);
+}
+#else
+std::string defaultSocketPath() { return ""; }
+
+int runServer(const std::string&, const RequestHandler&) {
+    std::cerr << "--server is not supported on this platform\n";
+    return 1;
+}
+
+int requestServer(const std::string&, const std::vector<std::string>&) {
+    return -1;
+}
+#endif
@@ -1,110 +1,354 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <mutex>
+#include <sstream>
+#include <charconv>
+#include <thread>
 #include <filesystem>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <cli/cli.h>
+#include <process/process.h>
+#include <server/server.h>
+#include <build/scheduler.h>
+#include <cache/cache.h>
 #include <pre-processor/pre-processor.h>
 #include <swirl.typedefs/swirl_t.h>
 #include <tokenizer/InputStream.h>
+#include <tokenizer/SourceFile.h>
 #include <tokenizer/Tokenizer.h>
 #include <transpiler/transpiler.h>
+#include <context/CompilationContext.h>
 #include <parser/parser.h>
+#include <utils/TimeReport.h>
 #include <include/SwirlConfig.h>
 
-bool SW_DEBUG = false;
-std::string SW_FED_FILE_PATH;
-std::string SW_OUTPUT;
-std::string SW_FED_FILE_SOURCE;
-std::vector<std::string> lines_rec{};
-
 
 const std::vector<Argument> application_flags = {
         {{"-h","--help"}, "Show the help message", false, {}},
         {{"-o", "--output"}, "Output file name", true, {}},
         {{"-c", "--compiler"}, "C++ compiler to use", true, {}},
         {{"-d", "--debug"}, "Log the steps of compilation", false, {}},
+        {{"-j", "--jobs"}, "Number of files to build at once, defaults to the number of cores", true, {}},
+        {{"-f", "--force"}, "Rebuild even if the cached build is up to date", false, {}},
+        {{"-t", "--time-report"}, "Report time and memory of each phase, as a table ('table') or a Chrome trace (<file>.json)", true, {}},
+        {{"-s", "--server"}, "Serve builds on a Unix socket from a long-running process", false, {}},
+        {{"-u", "--use-server"}, "Build through a running server, or locally if there is none", false, {}},
+        {{"-S", "--socket"}, "Socket of the server, defaults to $XDG_RUNTIME_DIR/swirl.sock", true, {}},
         {{"-v", "--version"}, "Show the version of Swirl", false, {}}
 };
 
 
-/* Lookup table for registered types and their visibility. */
-std::unordered_map<std::string, const char*> type_registry = {
-        // Pre-registered default types.
-        {"int",     "global"},
-        {"string",  "global"},
-        {"bool",    "global"},
-        {"float",   "global"},
-        {"var",     "global"},
-        {"function","global"}
-};
+/* Per-phase measurements of this run, enabled by --time-report. */
+TimeReport  time_report;
+std::string time_report_target;
 
-int main(int argc, const char** const argv) {
-    
-    cli app(argc, argv, application_flags);
+/** @brief prints the time report or writes it as a trace, registered with atexit so every way out reports */
+void emitTimeReport() {
+    if (time_report_target == "table") {
+        time_report.print(std::cerr);
+        return;
+    }
 
-    if (app.contains_flag("-h")) {
-        std::cout << USAGE << app.generate_help() << '\n';
-        return 0;
+    if (!time_report.writeTrace(time_report_target))
+        std::cerr << "Could not write the time report to '" << time_report_target << "'\n";
+}
+
+int buildFile(cli& _app, const std::string& _cxx, std::string _path, std::ostream& _err, BuildCache* _cache);
+
+/**
+ * @brief Builds several files, or every .sw file under a directory, on a pool of threads
+ *
+ * Files are built `-j` at a time, a file only once the files it imports from have been built.
+ * Each build has a CompilationContext of its own, so the front ends run side by side.
+ */
+int buildModules(cli& _app, const std::string& _cxx, const std::vector<std::string>& _inputs, std::ostream& _err) {
+    bool _debug = _app.contains_flag("-d");
+
+    if (_app.contains_flag("-o")) {
+        _err << "'-o' can't be used when building more than one file\n";
+        return 1;
     }
 
-    if (app.contains_flag("-v")) {
-        std::cout << "Swirl v" << swirl_VERSION_MAJOR << "." << swirl_VERSION_MINOR << "." << swirl_VERSION_PATCH << "\n";
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    if (_app.contains_flag("-j")) {
+        std::string value = _app.get_flag_value("-j");
+        auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), jobs);
+        if (ec != std::errc() || end != value.data() + value.size()) {
+            _err << "'-j' expects a number of jobs, got '" << value << "'\n";
+            return 1;
+        }
+        jobs = std::max(1u, jobs);
+    }
+
+    auto plan_phase = time_report.phase("plan");
+    std::vector<std::string> sources = collectSources(_inputs);
+    std::unordered_set<std::string> cache_dirs;
+    for (const std::string& source : sources) {
+        if (!std::filesystem::exists(source)) {
+            _err << "File '" << source << "' not found!" << std::endl;
+            return 1;
+        }
+
+        // set up the shared cache directories before the builds race each other for them
+        std::string cache_dir = getWorkingDirectory(source) + PATH_SEP + "__swirl_cache__" + PATH_SEP;
+        if (cache_dirs.insert(cache_dir).second) {
+            std::filesystem::create_directories(cache_dir);
+            precompilePrelude(cache_dir + SWIRL_PRELUDE_HEADER, splitCommand(_cxx), RUNTIME_PRELUDE);
+        }
+    }
+
+    std::vector<BuildJob> plan = planBuild(sources);
+    plan_phase.end();
+    LOG_TO(_err, "Building " << plan.size() << " files, " << jobs << " at a time")
+
+    auto build_phase = time_report.phase("build");
+    std::mutex output_mtx;
+    bool success = runJobs(plan, jobs, [&](const BuildJob& _job) {
+        // each build's output is printed in one piece once it is done
+        std::ostringstream job_err;
+        int exit_code = buildFile(_app, _cxx, _job.source, job_err, nullptr);
+
+        std::lock_guard lock(output_mtx);
+        _err << job_err.str();
+        if (exit_code != 0)
+            _err << "Building '" << _job.source << "' failed with exit code " << exit_code << "\n";
+        return exit_code == 0;
+    }, _err);
+
+    return success ? 0 : 1;
+}
+
+/**
+ * @brief Builds a single file, unless its manifest says the executable is up to date
+ *
+ * @param _cache what a server remembers between requests, nullptr to read everything from __swirl_cache__
+ */
+int buildFile(cli& _app, const std::string& _cxx, std::string _path, std::ostream& _err, BuildCache* _cache) {
+    bool _debug = _app.contains_flag("-d");
+
+    if (!std::filesystem::exists(_path)) {
+        _err << "File '" << _path << "' not found!" << std::endl;
+        return 1;
+    }
+
+    auto read_phase = time_report.phase("read");
+    SourceFile fed_file(_path);
+    CompilationContext ctx(fed_file.view());
+    read_phase.end();
+
+    std::string cache_dir = getWorkingDirectory(_path) + PATH_SEP + "__swirl_cache__" + PATH_SEP;
+
+    std::string file_name = _path.substr(_path.find_last_of("/\\") + 1);
+    std::string out_dir = _path.replace(_path.find(file_name),file_name.length(),"");
+    file_name = file_name.substr(0, file_name.find_last_of("."));
+
+    std::string output = file_name;
+
+    if (_app.contains_flag("-o"))
+        output = _app.get_flag_value("-o");
+
+    std::string build_file  = cache_dir + output + ".cpp";
+    std::vector<std::string> compile_cmd = splitCommand(_cxx);
+    if (compile_cmd.empty()) {
+        _err << "No C++ compiler given\n";
+        return 1;
+    }
+    std::vector<std::string> cxx_cmd = compile_cmd;
+    compile_cmd.insert(compile_cmd.end(), {build_file, "-o", out_dir + output});
+
+    BuildManifest manifest = {
+            .source_hash = hashContent(ctx.source),
+            .compiler    = _cxx,
+            .command     = joinCommand(compile_cmd),
+            .version     = swirl_VERSION
+    };
+    std::string manifest_path = cache_dir + output + ".manifest";
+
+    std::optional<BuildManifest> last_build;
+    if (_cache && _cache->manifests.contains(manifest_path)) last_build = _cache->manifests[manifest_path];
+    else last_build = BuildManifest::load(manifest_path);
+
+    if (!_app.contains_flag("-f") && last_build == manifest && std::filesystem::exists(out_dir + output)) {
+        LOG_TO(_err, "'" << out_dir + output << "' is up to date")
         return 0;
     }
 
+    if ( !ctx.source.empty() ) {
+        // the parser lexes on demand, so lex once more on its own to tell the two apart
+        if (time_report.enabled()) {
+            auto lex_phase = time_report.phase("lex");
+            InputStream lex_is(ctx.source);
+            TokenStream lex_tk(lex_is, ctx.symbols);
+            while (lex_tk.next(true, true).type != NONE) {}
+        }
+
+        InputStream is(ctx.source);
+        TokenStream tk(is, ctx.symbols, _debug);
+
+        auto preprocess_phase = time_report.phase("preprocess");
+        preProcess(tk, cache_dir);
+        preprocess_phase.end();
+
+        auto parse_phase = time_report.phase("parse (+lex)");
+        Parser parser(tk, ctx);
+        parser.dispatch();
+        parse_phase.end();
+        LOG_TO(_err, "AST: " << parser.m_AST->nodeCount() << " nodes, " << parser.m_AST->memoryUsage() << " bytes, "
+            << ctx.symbols.size() << " interned symbols")
+
+        auto transpile_phase = time_report.phase("transpile");
+        Transpile(ctx, *parser.m_AST, parser.m_AST->chl, build_file, ctx.output.main);
+        if (!ctx.output.write(build_file)) {
+            _err << "Could not write '" << build_file << "'\n";
+            return 1;
+        }
+    }
+
+    auto pch_phase = time_report.phase("precompile prelude");
+    std::string prelude_header = cache_dir + SWIRL_PRELUDE_HEADER;
+    std::string prelude_key    = prelude_header + "\n" + _cxx;
+
+    std::vector<std::string> pch_flags;
+    if (_cache && _cache->preludes.contains(prelude_key) && std::filesystem::exists(prelude_header))
+        pch_flags = _cache->preludes[prelude_key];
+    else pch_flags = precompilePrelude(prelude_header, cxx_cmd, RUNTIME_PRELUDE);
+    if (_cache) _cache->preludes[prelude_key] = pch_flags;
+
+    compile_cmd.insert(compile_cmd.end(), pch_flags.begin(), pch_flags.end());
+    pch_phase.end();
+
+    auto compile_phase = time_report.phase("backend compile");
+    ProcessResult result = runProcess(compile_cmd);
+    compile_phase.end();
+    _err << result.output;
+    if (!result.ok()) {
+        LOG_TO(_err, "'" << joinCommand(compile_cmd) << "' exited with code " << result.exit_code)
+        return result.exit_code;
+    }
+
+    manifest.save(manifest_path);
+    if (_cache) _cache->manifests[manifest_path] = manifest;
+    return 0;
+}
+
+/** @brief builds what `_app` asks for, the part of a run a server does on behalf of its clients */
+int runCommand(cli& _app, std::ostream& _err, BuildCache* _cache) {
     std::string cxx;
 
-    if (app.contains_flag("-c"))
-        cxx = app.get_flag_value("-c");
+    if (_app.contains_flag("-c"))
+        cxx = _app.get_flag_value("-c");
     else cxx = "g++";
 
-    std::optional<std::string> _file = app.get_file();
+    std::vector<std::string> _files = _app.get_files();
 
-    if (!_file.has_value()) { 
-        std::cerr << "No Input file\n"; return 1; 
+    if (_files.empty()) { 
+        _err << "No Input file\n"; return 1; 
     }
-    
-    SW_FED_FILE_PATH = *app.get_file();
 
-    if (!std::filesystem::exists(SW_FED_FILE_PATH)) {
-        std::cerr << "File '" << SW_FED_FILE_PATH << "' not found!" << std::endl;
+    if (_files.size() > 1 || std::filesystem::is_directory(_files.front()))
+        return buildModules(_app, cxx, _files, _err);
+
+    return buildFile(_app, cxx, _files.front(), _err, _cache);
+}
+
+/**
+ * @brief the arguments to send a server for this run: input paths are made absolute since the
+ * server runs elsewhere, and the flags that only concern the client are dropped
+ */
+std::vector<std::string> serverRequest(int argc, const char** argv, cli& _app) {
+    std::vector<std::string> files = _app.get_files();
+    std::vector<std::string> args = {argv[0]};
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        auto flag = std::find_if(application_flags.begin(), application_flags.end(), [&](const Argument& _flag) {
+            return std::get<0>(_flag.flags) == arg || std::get<1>(_flag.flags) == arg;
+        });
+
+        if (flag == application_flags.end()) {
+            args.push_back(std::find(files.begin(), files.end(), arg) != files.end()
+                           ? std::filesystem::absolute(argv[i]).string() : argv[i]);
+            continue;
+        }
+
+        std::string_view name = std::get<0>(flag->flags);
+        bool local = name == "-u" || name == "-S" || name == "-t";
+        if (!local) args.emplace_back(arg);
+        if (flag->value_required && ++i < argc && !local) args.emplace_back(argv[i]);
+    }
+
+    return args;
+}
+
+int main(int argc, const char** const argv) {
+    
+    cli app(argc, argv, application_flags);
+    if (!app.error().empty()) {
+        std::cerr << app.error() << '\n';
         return 1;
     }
 
-    std::ifstream fed_file_src_buf(SW_FED_FILE_PATH);
-    SW_FED_FILE_SOURCE = {
-            std::istreambuf_iterator<char>(fed_file_src_buf),
-            {}
-    };
-    fed_file_src_buf.close();
+    if (app.contains_flag("-h")) {
+        std::cout << USAGE << app.generate_help() << '\n';
+        return 0;
+    }
+
+    if (app.contains_flag("-v")) {
+        std::cout << "Swirl v" << swirl_VERSION_MAJOR << "." << swirl_VERSION_MINOR << "." << swirl_VERSION_PATCH << "\n";
+        return 0;
+    }
 
-    std::string cache_dir = getWorkingDirectory(SW_FED_FILE_PATH) + PATH_SEP + "__swirl_cache__" + PATH_SEP;
-    bool _debug = app.contains_flag("-d");
+    std::string socket_path = app.contains_flag("-S") ? app.get_flag_value("-S") : defaultSocketPath();
 
-    std::string file_name = SW_FED_FILE_PATH.substr(SW_FED_FILE_PATH.find_last_of("/\\") + 1);
-    std::string out_dir = SW_FED_FILE_PATH.replace(SW_FED_FILE_PATH.find(file_name),file_name.length(),"");
-    file_name = file_name.substr(0, file_name.find_last_of("."));
+    if (app.contains_flag("-s")) {
+        BuildCache cache;
+        std::string cxx = app.contains_flag("-c") ? app.get_flag_value("-c") : "g++";
+        return runServer(socket_path, [&](const std::vector<std::string>& _args, std::ostream& _out) {
+            if (_args.empty()) return 1;
 
-    SW_OUTPUT = file_name;
+            std::vector<const char*> req_argv;
+            for (const std::string& arg : _args) req_argv.push_back(arg.c_str());
 
-    if (app.contains_flag("-o"))
-        SW_OUTPUT = app.get_flag_value("-o");
+            cli request(static_cast<int>(req_argv.size()), req_argv.data(), application_flags);
+            if (!request.error().empty()) {
+                _out << request.error() << '\n';
+                return 1;
+            }
 
-    SW_FED_FILE_SOURCE += "\n";
+            // requests build with the server's compiler, anyone able to pick the compiler could run any
+            // program as the server's user
+            if (!request.contains_flag("-c")) {
+                req_argv.insert(req_argv.end(), {"-c", cxx.c_str()});
+                request = cli(static_cast<int>(req_argv.size()), req_argv.data(), application_flags);
+            } else if (request.get_flag_value("-c") != cxx) {
+                _out << "The server builds with '" << cxx << "', start one with '-c " << request.get_flag_value("-c")
+                     << "' to build with that compiler\n";
+                return 1;
+            }
 
-    if ( !SW_FED_FILE_SOURCE.empty() ) {
-        InputStream is(SW_FED_FILE_SOURCE);
-        TokenStream tk(is, _debug);
-        preProcess(SW_FED_FILE_SOURCE, tk, cache_dir);
+            return runCommand(request, _out, &cache);
+        });
+    }
 
-        Parser parser(tk);
-        parser.dispatch();
-        Transpile(parser.m_AST->chl, cache_dir + SW_OUTPUT + ".cpp", compiled_source);
+    if (app.contains_flag("-u")) {
+        if (app.contains_flag("-t"))
+            std::cerr << "--time-report is not sent to the server, it only covers local builds\n";
+
+        int exit_code = requestServer(socket_path, serverRequest(argc, argv, app));
+        if (exit_code != -1) return exit_code;
+
+        bool _debug = app.contains_flag("-d");
+        LOG("No server on '" << socket_path << "', building locally")
     }
- 
-    std::string compile_cmd = cxx + " " + cache_dir + SW_OUTPUT + ".cpp" + " -o " + out_dir + SW_OUTPUT;
-       
-    system(compile_cmd.c_str());
+
+    if (app.contains_flag("-t")) {
+        time_report_target = app.get_flag_value("-t");
+        time_report.enable();
+        std::atexit(emitTimeReport);
+    }
+
+    return runCommand(app, std::cerr, nullptr);
 }
@@ -1,80 +1,142 @@
-#include <iostream>
-#include <string>
-#include <cstring>
-#include <vector>
-
-class Swirl_String
-{
-public:
-    char *value;
-    Swirl_String(char *val) : value(val) {}
-    Swirl_String(std::string val) : value((char *)val.c_str()) {}
-    Swirl_String(const char *val) : value((char *)val) {}
-
-    // bool operator!=(Swirl_String comp) { return comp.__to_cstr__() != value; }
-    // bool operator==(Swirl_String comp) { return comp.__to_cstr__() == value; }
-
-    Swirl_String operator+(Swirl_String str) const { return strcat(value, str.__to_cstr__()); }
-    Swirl_String operator*(int num) const { return strncat(value, value, num); }
-
-    bool operator==(Swirl_String comp) const { return strcmp(value, comp.__to_cstr__()) == 0; }
-    bool operator!=(Swirl_String comp) const { return strcmp(value, comp.__to_cstr__()) != 0; }
-    bool has(Swirl_String str) { return strstr(value, str.__to_cstr__()) != nullptr; }
-
-    int length() { return strlen(value); }
-    bool isEmpty() { return strlen(value) == 0; }
-
-    std::vector<Swirl_String> split(Swirl_String chr)
-    {
-        std::vector<Swirl_String> result;
-        char *str = value;
-        char *token = strtok(str, chr.__to_cstr__());
-        while (token != nullptr)
-        {
-            result.emplace_back(token);
-            token = strtok(nullptr, chr.__to_cstr__());
-        }
-        return result;
-    }
+#include <algorithm>
+#include <functional>
+
+#include <swirl.string/String.h>
+
+void Swirl_String::grow(std::size_t _capacity) {
+    _capacity = std::max(_capacity, capacity() * 2);
+    char* data = new char[_capacity + 1];
+    std::memcpy(data, m_Data, m_Size + 1);
 
-    [[nodiscard]] Swirl_String erase(Swirl_String str) const
-    {
-        char *result = strstr(value, str.__to_cstr__());
-        if (result != nullptr)
-        {
-            char *new_str = new char[strlen(value) - strlen(str.__to_cstr__()) + 1];
-            strcpy(new_str, value);
-            strcpy(new_str + (result - value), result + strlen(str.__to_cstr__()));
-            return {new_str};
-        }
-        return {value};
+    if (!isLocal()) delete[] m_Data;
+    m_Data = data;
+    m_Capacity = _capacity;
+}
+
+void Swirl_String::assign(const char* _str, std::size_t _size) {
+    if (_size > capacity()) {
+        // nothing worth keeping, so no copy of the old contents
+        if (!isLocal()) delete[] m_Data;
+        m_Data = m_Local;
+        m_Size = 0;
+        grow(_size);
     }
+    std::memmove(m_Data, _str, _size);
+    m_Data[_size] = '\0';
+    m_Size = _size;
+}
 
-    int find(Swirl_String str)
-    {
-        for (int i = 0; i < str.length(); i++)
-            if (value[i] == str.value[0])
-                return i;
+void Swirl_String::steal(Swirl_String& _other) {
+    m_Size = _other.m_Size;
+    if (_other.isLocal()) {
+        m_Data = m_Local;
+        std::memcpy(m_Local, _other.m_Local, m_Size + 1);
+    } else {
+        m_Data = _other.m_Data;
+        m_Capacity = _other.m_Capacity;
     }
 
-    Swirl_String replace(Swirl_String before, Swirl_String after)
-    {
-        char *result = strstr(value, before.__to_cstr__());
-        if (result != nullptr)
-        {
-            char *new_str = new char[strlen(value) - strlen(before.__to_cstr__()) + strlen(after.__to_cstr__()) + 1];
-            strcpy(new_str, value);
-            strcpy(new_str + (result - value), after.__to_cstr__());
-            return {new_str};
-        }
-        return {value};
+    _other.m_Data = _other.m_Local;
+    _other.m_Local[0] = '\0';
+    _other.m_Size = 0;
+}
+
+Swirl_String& Swirl_String::operator=(const Swirl_String& _other) {
+    if (this != &_other) assign(_other.m_Data, _other.m_Size);
+    return *this;
+}
+
+Swirl_String& Swirl_String::operator=(Swirl_String&& _other) noexcept {
+    if (this == &_other) return *this;
+    if (!isLocal()) delete[] m_Data;
+    steal(_other);
+    return *this;
+}
+
+Swirl_String& Swirl_String::operator+=(std::string_view _str) {
+    if (m_Size + _str.size() > capacity()) {
+        // `_str` may point into this string (`s += s`), it has to follow the buffer when it moves
+        std::less_equal<const char*> le;
+        bool aliased = le(m_Data, _str.data()) && le(_str.data(), m_Data + m_Size);
+        std::size_t offset = aliased ? _str.data() - m_Data : 0;
+
+        grow(m_Size + _str.size());
+        if (aliased) _str = {m_Data + offset, _str.size()};
     }
 
-    int toInt() { return atoi(value); }
-    double toFloat() { return atof(value); }
-    double toBool() { return static_cast<bool>(value); }
+    std::memmove(m_Data + m_Size, _str.data(), _str.size());
+    m_Size += _str.size();
+    m_Data[m_Size] = '\0';
+    return *this;
+}
+
+Swirl_String Swirl_String::operator+(std::string_view _str) const {
+    Swirl_String ret;
+    ret.reserve(m_Size + _str.size());
+    ret += view();
+    ret += _str;
+    return ret;
+}
+
+Swirl_String Swirl_String::operator*(int _num) const {
+    Swirl_String ret;
+    if (_num <= 0) return ret;
+
+    ret.reserve(m_Size * _num);
+    for (int i = 0; i < _num; i++)
+        ret += view();
+    return ret;
+}
 
-    const char *__rr__() { return ""; }
-    const char *__to_cstr__() { return value; }
-    std::string __to_cpp_str__() { return std::string(value); }
-};
\ No newline at end of file
+std::vector<std::string_view> Swirl_String::split(std::string_view _sep) const {
+    std::string_view str = view();
+    if (_sep.empty()) return {str};
+
+    std::vector<std::string_view> result;
+    std::size_t begin = 0;
+    for (std::size_t end; (end = Swirl::search(str, _sep, begin)) != Swirl::npos; begin = end + _sep.size())
+        result.emplace_back(str.substr(begin, end - begin));
+    result.emplace_back(str.substr(begin));
+    return result;
+}
+
+Swirl_String Swirl_String::erase(std::string_view _str) const {
+    return replace(_str, "");
+}
+
+long long Swirl_String::find(std::string_view _str) const {
+    std::size_t pos = Swirl::search(view(), _str);
+    return pos == Swirl::npos ? -1 : static_cast<long long>(pos);
+}
+
+Swirl_String Swirl_String::replace(std::string_view _before, std::string_view _after) const {
+    std::size_t pos = Swirl::search(view(), _before);
+    if (pos == Swirl::npos) return *this;
+
+    Swirl_String ret;
+    ret.reserve(m_Size - _before.size() + _after.size());
+    ret += view().substr(0, pos);
+    ret += _after;
+    ret += view().substr(pos + _before.size());
+    return ret;
+}
+
+Swirl_String Swirl_String::replaceAll(std::string_view _before, std::string_view _after) const {
+    if (_before.empty()) return *this;
+
+    std::string_view str = view();
+    std::size_t pos = Swirl::search(str, _before);
+    if (pos == Swirl::npos) return *this;
+
+    Swirl_String ret;
+    ret.reserve(_after.size() > _before.size() ? m_Size + m_Size / 4 : m_Size);
+
+    std::size_t begin = 0;
+    for (; pos != Swirl::npos; pos = Swirl::search(str, _before, begin)) {
+        ret += str.substr(begin, pos - begin);
+        ret += _after;
+        begin = pos + _before.size();
+    }
+    ret += str.substr(begin);
+    return ret;
+}
@@ -0,0 +1,25 @@
+#include <symbols/Interner.h>
+
+SymbolId Interner::intern(std::string_view _str) {
+    auto it = m_Ids.find(_str);
+    if (it != m_Ids.end()) return it->second;
+
+    std::string_view owned = m_Arena.store(_str);
+    auto id = static_cast<SymbolId>(m_Strings.size());
+    m_Strings.push_back(owned);
+    m_Ids.emplace(owned, id);
+    return id;
+}
+
+SymbolId Interner::find(std::string_view _str) const {
+    auto it = m_Ids.find(_str);
+    return it == m_Ids.end() ? NO_SYMBOL : it->second;
+}
+
+std::string_view Interner::view(SymbolId _id) const {
+    return m_Strings[_id];
+}
+
+std::size_t Interner::size() const {
+    return m_Strings.size();
+}
@@ -1,30 +1,42 @@
-#include <sstream>
 #include <tokenizer/InputStream.h>
 
-InputStream::InputStream(std::string& _source): m_Source(_source) {
-    std::stringstream src_strm(_source);
-}
+InputStream::InputStream(std::string_view _source, uint32_t _fileId): m_Source(_source), m_FileId(_fileId) {}
 
 char InputStream::peek() {
-    return m_Source.at(m_Pos);
+    return m_Source.data()[m_Pos];
 }
 
 char InputStream::next(bool _noIncrement) {
     if (_noIncrement) {
-        char chr = m_Source.at(m_Pos + 1);
+        char chr = m_Source.data()[m_Pos + 1];
         return chr;
     }
 
-    char chr = m_Source.at(m_Pos++);
-    if (chr == '\n') { m_Line++; m_Col = 0; }
-    else {
-        m_Col++;
-    }
-    return chr;
+    return m_Source.data()[m_Pos++];
 }
 
 void InputStream::reset() {
-    m_Col = m_Pos = 0; m_Line = 1;
+    m_Pos = 0;
+}
+
+std::string_view InputStream::rest() const {
+    return m_Source.substr(m_Pos);
+}
+
+void InputStream::skip(std::size_t _count) {
+    m_Pos += _count;
+}
+
+std::string_view InputStream::slice(std::size_t _begin) const {
+    return m_Source.substr(_begin, m_Pos - _begin);
+}
+
+std::string_view InputStream::slice(std::size_t _begin, std::size_t _end) const {
+    return m_Source.substr(_begin, _end - _begin);
+}
+
+SourceSpan InputStream::span(std::size_t _begin) const {
+    return {m_FileId, static_cast<uint32_t>(_begin), static_cast<uint32_t>(m_Pos - _begin)};
 }
 
 bool InputStream::eof() {
@@ -35,10 +47,3 @@ std::size_t InputStream::getPos() const {
     return m_Pos;
 }
 
-std::size_t InputStream::getLine() const {
-    return m_Line;
-}
-
-std::size_t InputStream::getCol() const {
-    return m_Col;
-}
@@ -0,0 +1,55 @@
+#include <fstream>
+#include <iterator>
+#include <tokenizer/SourceFile.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+SourceFile::SourceFile(const std::string& _path) {
+#ifndef _WIN32
+    int fd = open(_path.c_str(), O_RDONLY);
+    struct stat st{};
+
+    if (fd != -1 && fstat(fd, &st) == 0 && st.st_size > 0) {
+        std::size_t size = st.st_size;
+        // an anonymous reservation one byte longer than the file backs the newline and the
+        // sentinel, even when the file ends exactly on a page boundary
+        m_MapSize = size + 2;
+        void* region = mmap(nullptr, m_MapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (region != MAP_FAILED) {
+            if (mmap(region, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED) {
+                m_Map = static_cast<char*>(region);
+                m_Map[size] = '\n';
+                m_Map[size + 1] = '\0';
+                m_Source = {m_Map, size + 1};
+#ifdef MADV_SEQUENTIAL
+                madvise(m_Map, m_MapSize, MADV_SEQUENTIAL);
+#endif
+            } else munmap(region, m_MapSize);
+        }
+    }
+
+    if (fd != -1) close(fd);
+    if (m_Map) return;
+#endif
+
+    std::ifstream file_buf(_path, std::ios::binary);
+    m_Fallback = {std::istreambuf_iterator<char>(file_buf), {}};
+    m_Fallback += "\n";
+    m_Source = m_Fallback;
+}
+
+SourceFile::~SourceFile() {
+#ifndef _WIN32
+    if (m_Map) munmap(m_Map, m_MapSize);
+#endif
+}
+
+std::string_view SourceFile::view() const {
+    return m_Source;
+}
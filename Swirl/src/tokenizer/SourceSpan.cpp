@@ -0,0 +1,23 @@
+#include <algorithm>
+#include <tokenizer/SourceSpan.h>
+
+void LineIndex::build() const {
+    m_Starts.push_back(0);
+    for (std::size_t i = 0; i < m_Source.size(); i++)
+        if (m_Source[i] == '\n') m_Starts.push_back(i + 1);
+}
+
+std::pair<std::size_t, std::size_t> LineIndex::locate(uint32_t _offset) const {
+    if (m_Starts.empty()) build();
+    auto it = std::upper_bound(m_Starts.begin(), m_Starts.end(), _offset) - 1;
+    return {it - m_Starts.begin() + 1, _offset - *it};
+}
+
+std::string_view LineIndex::line(std::size_t _line) const {
+    if (m_Starts.empty()) build();
+    if (_line == 0 || _line > m_Starts.size()) return {};
+
+    std::size_t begin = m_Starts[_line - 1];
+    std::size_t end   = _line < m_Starts.size() ? m_Starts[_line] - 1 : m_Source.size();
+    return m_Source.substr(begin, end - begin);
+}
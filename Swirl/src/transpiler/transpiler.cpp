@@ -1,59 +1,262 @@
 #include <variant>
 #include <optional>
+#include <charconv>
+#include <fstream>
+#include <filesystem>
 #include <unordered_map>
 
 #include <parser/parser.h>
+#include <transpiler/transpiler.h>
+#include <context/CompilationContext.h>
 
-#define SC_IF_IN_PRNS if (!prn_ind) _dest += ";"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
 
-extern std::unordered_map<std::string, const char*> type_registry;
+#define SC_IF_IN_PRNS if (!prn_ind) _dest += ";"
 
-std::unordered_map<std::string, std::string> symbol_table;
+const std::string RUNTIME_PRELUDE = R"(#ifndef SWIRL_PRELUDE_H
+#define SWIRL_PRELUDE_H
 
-std::string compiled_funcs;
-std::string compiled_source = R"(
+#include <cstdio>
+#include <cstring>
+#include <charconv>
 #include <iostream>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 #include <functional>
 
+#ifdef _WIN32
+#include <io.h>
+#define __swirl_isatty(__Fd) _isatty(__Fd)
+#else
+#include <unistd.h>
+#define __swirl_isatty(__Fd) isatty(__Fd)
+#endif
+
+/*
+ * print() and input() write through stdout's own buffer, enlarged to 64 KiB and set up before main()
+ * (line buffered on a terminal), so output of printf, puts or std::cout stays in order with theirs.
+ * Numbers are formatted with to_chars, in the same format `std::cout <<` would have used.
+ */
+inline const bool __swirl_stdout_buffered = [] {
+    return std::setvbuf(stdout, nullptr, __swirl_isatty(1) ? _IOLBF : _IOFBF, 1 << 16) == 0;
+}();
+
+inline void __swirl_write(std::string_view __Str) {
+    std::fwrite(__Str.data(), 1, __Str.size(), stdout);
+}
+
+template < typename Num >
+void __swirl_write_number(Num __Num) {
+    char buf[64];
+    std::to_chars_result res;
+    if constexpr (std::is_floating_point_v<Num>)
+        res = std::to_chars(buf, buf + sizeof(buf), __Num, std::chars_format::general, 6);
+    else res = std::to_chars(buf, buf + sizeof(buf), __Num);
+    __swirl_write({buf, static_cast<std::size_t>(res.ptr - buf)});
+}
+
+template < typename Obj >
+void print(const Obj& __Obj, std::string_view __End = "\n", bool __Flush = false) {
+    using Type = std::decay_t<Obj>;
+
+    if constexpr (std::is_same_v<Type, bool>) __swirl_write(__Obj ? "true" : "false");
+    // chars of any signedness (int8_t too) print as characters, as they do with std::cout
+    else if constexpr (std::is_same_v<Type, char> || std::is_same_v<Type, signed char>
+                       || std::is_same_v<Type, unsigned char>) std::fputc(static_cast<unsigned char>(__Obj), stdout);
+    else if constexpr (std::is_arithmetic_v<Type>) __swirl_write_number(__Obj);
+    else if constexpr (std::is_convertible_v<const Obj&, std::string_view>) __swirl_write(__Obj);
+    else {
+        std::ostringstream buf;
+        buf << std::boolalpha << __Obj;
+        __swirl_write(buf.str());
+    }
+
+    __swirl_write(__End);
+    if (__Flush) std::fflush(stdout);
+}
+
+inline std::string input(std::string_view __Prompt) {
+    __swirl_write(__Prompt);
+    std::fflush(stdout);
+
+    std::string ret;
+    std::getline(std::cin, ret);
+    return ret;
+}
+
+/* range(end) or range(begin, end, step) as a lazy view, iterating it is a counted loop */
+class range {
+    long long m_Begin, m_End, m_Step;
+
+public:
+    struct iterator {
+        long long value, step;
+
+        long long operator*() const { return value; }
+        iterator& operator++() { value += step; return *this; }
+
+        // ordered rather than equal, a step can jump over the end
+        bool operator!=(const iterator& __Other) const {
+            return step > 0 ? value < __Other.value : value > __Other.value;
+        }
+    };
+
+    explicit range(long long __End) : range(0, __End) {}
+    range(long long __Begin, long long __End, long long __Step = 1)
+        : m_Begin(__Begin), m_End(__End), m_Step(__Step ? __Step : 1) {}
+
+    iterator begin() const { return {m_Begin, m_Step}; }
+    iterator end() const { return {m_End, m_Step}; }
+};
+
+#endif
+)";
+
+CompiledOutput::CompiledOutput()
+    : prelude("#include \"" SWIRL_PRELUDE_HEADER "\"\n"),
+      // after the `importc`ed headers, so these don't leak into them
+      macros(R"(
 #define elif else if
 #define var auto
 #define in :
 #define function std::function
 
 using string = std::string;
+)") {}
 
-template < typename Obj >
-void print(Obj __Obj, const std::string& __End = "\n", bool __Flush = true) {
-    if (__Flush) std::cout << std::boolalpha << __Obj << __End << std::flush;
-    else std::cout << std::boolalpha << __Obj << __End;
+void CompiledOutput::spill(const std::string& _buildFile, std::string& _section, std::size_t _keep) {
+    std::ofstream& part = &_section == &funcs ? funcs_part : main_part;
+    if (!part.is_open())
+        part.open(_buildFile + (&_section == &funcs ? ".funcs.part" : ".main.part"), std::ios::binary);
+
+    std::size_t count = _section.size() > _keep ? _section.size() - _keep : 0;
+    part.write(_section.data(), static_cast<std::streamsize>(count));
+    _section.erase(0, count);
 }
 
-std::string input(const std::string& __Prompt) {
+/** @brief streams the part file `_part` into `_out` and deletes it */
+static void appendPart(std::ofstream& _out, std::ofstream& _partBuf, const std::string& _part) {
+    if (!_partBuf.is_open()) return;
+    _partBuf.close();
+
+    std::ifstream part(_part, std::ios::binary);
+    _out << part.rdbuf();
+    part.close();
+    std::filesystem::remove(_part);
+}
+
+bool CompiledOutput::write(const std::string& _path) {
+    if (funcs_part.is_open() || main_part.is_open()) {
+        std::ofstream o_file_buf(_path, std::ios::binary);
+        o_file_buf << prelude << includes << "\n" << macros;
+        appendPart(o_file_buf, funcs_part, _path + ".funcs.part");
+        o_file_buf << funcs << "\n";
+        appendPart(o_file_buf, main_part, _path + ".main.part");
+        o_file_buf << main;
+        return o_file_buf.good();
+    }
+
+    std::array<std::string_view, 7> pieces = {
+            prelude, includes, "\n", macros, funcs, "\n", main
+    };
+
+#ifndef _WIN32
+    int fd = open(_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) return false;
+
+    std::array<iovec, pieces.size()> iov{};
+    for (std::size_t i = 0; i < pieces.size(); i++)
+        iov[i] = {const_cast<char*>(pieces[i].data()), pieces[i].size()};
+
+    // writev may stop short, resume from the first piece that wasn't fully written
+    iovec* cur = iov.data();
+    int    left = static_cast<int>(iov.size());
+    while (left > 0) {
+        ssize_t written = writev(fd, cur, left);
+        if (written < 0) { close(fd); return false; }
+
+        while (left > 0 && static_cast<std::size_t>(written) >= cur->iov_len) {
+            written -= static_cast<ssize_t>(cur->iov_len);
+            ++cur; --left;
+        }
+        if (left > 0) {
+            cur->iov_base = static_cast<char*>(cur->iov_base) + written;
+            cur->iov_len -= written;
+        }
+    }
+    return close(fd) == 0;
+#else
+    std::ofstream o_file_buf(_path, std::ios::binary);
+    for (std::string_view piece : pieces)
+        o_file_buf.write(piece.data(), static_cast<std::streamsize>(piece.size()));
+    return o_file_buf.good();
+#endif
+}
+
+std::string CompiledOutput::str() const {
     std::string ret;
-    std::cout << __Prompt << std::flush;
-    std::getline(std::cin, ret);
+    ret.reserve(prelude.size() + includes.size() + macros.size() + funcs.size() + main.size() + 2);
+    ret.append(prelude).append(includes).append("\n").append(macros).append(funcs).append("\n").append(main);
     return ret;
 }
 
-std::vector<int> range(int __begin, int __end = 0) {
-    // TODO: use an input iterator
-    std::vector<int> ret{};
-    if (!__end) { __end = __begin; __begin = 0; }
-    for (int i = __begin; i < __end; i++)
-        ret.emplace_back(i);
-    return ret;
+/** @brief the value of `_text` if it is an integer literal (an optional sign, then digits), else nullopt */
+static std::optional<long long> integerLiteral(std::string_view _text) {
+    std::string digits;
+    for (char chr : _text)
+        if (chr != ' ') digits += chr;
+    if (!digits.empty() && digits.front() == '+') digits.erase(0, 1);
+
+    long long value = 0;
+    auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (digits.empty() || ec != std::errc() || end != digits.data() + digits.size()) return std::nullopt;
+    return value;
 }
-)";
 
-std::size_t bt_size = compiled_source.size();
+/**
+ * @brief a counted loop over the numeric range in the arg_nodes of `_loop`, laid out like range()'s
+ * arguments; the end is evaluated once, as it would be by range()
+ *
+ * Only a missing step or a nonzero integer literal one gives a counted loop, anything else (an
+ * expression, a fraction, 0) iterates the runtime range, which knows what to make of it.
+ */
+static std::string rangeLoop(AbstractSyntaxTree& _ast, const Node& _loop) {
+    std::vector<std::string> bounds;
+    for (const Node& bound : _ast.children(_loop.arg_nodes)) {
+        std::string_view text = bound.value;
+        while (text.ends_with(' ')) text.remove_suffix(1);
+        bounds.emplace_back(text);
+    }
+
+    std::string var   = std::string(_loop.ident);
+    std::string begin = bounds.size() > 1 ? bounds[0] : "0";
+    std::string end   = bounds.size() > 1 ? bounds[1] : bounds[0];
+
+    std::optional<long long> step = 1;
+    if (bounds.size() > 2) step = integerLiteral(bounds[2]);
+    if (!step || *step == 0)
+        return "for (auto&& " + var + " : range(" + begin + ", " + end + ", " + bounds[2] + ") )";
+
+    std::string end_var = "__" + var + "_end";
+    std::string ret = "for (decltype((" + begin + ") + (" + end + ")) " + var + " = (" + begin + "), "
+                      + end_var + " = (" + end + "); " + var + (*step > 0 ? " < " : " > ") + end_var + "; ";
+
+    if (*step == 1) return ret + "++" + var + ")";
+    return ret + var + " += " + std::to_string(*step) + ")";
+}
 
 char getNextChar(std::string& _str, std::size_t _index) noexcept {
     if (_index < _str.size()) return _str[_index + 1];
     return _str[_index];
 }
 
-std::string format(std::string& str) {
+std::string format(std::string_view str) {
     bool escape = false;
     std::string ret;
     std::size_t count = 0;
@@ -82,12 +285,14 @@ std::vector<std::string> splitStr(const std::string& str, char delimiter) {
 }
 
 
-std::optional<std::unordered_map<std::string, std::string>> Transpile(
-        std::list<Node>& _nodes,
+std::optional<std::unordered_map<SymbolId, std::string>> Transpile(
+        CompilationContext& _ctx,
+        AbstractSyntaxTree& _ast,
+        NodeList _nodes,
         const std::string& _buildFile,
-        std::string& _dest = compiled_source,
-        bool onlyAppend = false,
-        bool returnSymbolTable = false ) {
+        std::string& _dest,
+        bool onlyAppend,
+        bool returnSymbolTable ) {
 
     unsigned int     prn_ind       = 0;
     int              fn_br_ind     = 0;
@@ -99,22 +304,31 @@ std::optional<std::unordered_map<std::string, std::string>> Transpile(
     std::string      tmp_str_cnst{};
     TokenType        last_node_type{};
     std::string      last_func_ident{};
-    std::string      cimports{};
     std::string      cr_scope{};  // %: func-local, $: global-var, @: template-arg
-    std::string      macros{};
 
-    std::optional<std::unordered_map<std::string, std::string>> ret = {};
+    std::optional<std::unordered_map<SymbolId, std::string>> ret = {};
+
+    CompiledOutput&  output   = _ctx.output;
+    std::string&     cimports = output.includes;
+    std::string&     macros   = output.macros;
+    std::string&     compiled_funcs = output.funcs;
+    auto&            symbol_table   = _ctx.symbol_table;
+    auto&            type_registry  = _ctx.type_registry;
 
-    if (_dest == compiled_source)
+    if (&_dest == &output.main)
         _dest += "int main() {\n";
 
-    for (Node& child : _nodes) {
+    for (Node& child : _ast.children(_nodes)) {
+        // flush main() to disk as it grows, the last few chars stay since statements edit them afterwards
+        if (!onlyAppend && !_buildFile.empty() && _dest.size() >= CompiledOutput::SPILL_THRESHOLD)
+            output.spill(_buildFile, _dest, CompiledOutput::SPILL_KEEP);
+
         if (child.type == TYPEDEF)
-            macros += "using " + child.ident + " = " + child.value + ";";
+            macros += "using " + std::string(child.ident) + " = " + std::string(child.value) + ";";
 
         if (child.type == EXPORT)
-            for (Node& exp : child.body)
-                symbol_table[exp.value] = "";
+            for (Node& exp : _ast.children(child.body))
+                symbol_table[_ctx.symbols.intern(exp.value)] = "";
 
         if (child.type == OP) {
             if (!prn_ind)
@@ -126,36 +340,50 @@ std::optional<std::unordered_map<std::string, std::string>> Transpile(
         }
 
         if (child.type == STRING) {
-            if (is_include) { cimports += child.value + "\n"; is_include = false; continue; }
+            if (is_include) { cimports += std::string(child.value) + "\n"; is_include = false; continue; }
             else if (child.format) { _dest += "string(" + format(child.value) + ")"; SC_IF_IN_PRNS; continue; }
-            _dest += "string(" + child.value + ")";
+            _dest += "string(" + std::string(child.value) + ")";
             SC_IF_IN_PRNS;
             continue;
         }
 
         if (child.type == FUNCTION) {
             rd_function = true;
-            symbol_table[child.ident] = "";
+            symbol_table[_ctx.symbols.intern(child.ident)] = "";
             last_func_ident = child.ident;
 
             if (!child.template_args.empty()) {
                 compiled_funcs += "\n;template<";
-                for (const Node& t : child.template_args) {
-                    t.type == IDENT ? compiled_funcs += "typename " + t.value : compiled_source += child.value;
-                    symbol_table[t.value] = "%" + child.ident;
+                for (const Node& t : _ast.children(child.template_args)) {
+                    t.type == IDENT ? compiled_funcs += "typename " + std::string(t.value) : output.main += child.value;
+                    symbol_table[_ctx.symbols.intern(t.value)] = "%" + std::string(child.ident);
                 }
                 compiled_funcs += ">\n";
             }
 
             if (child.template_args.empty()) compiled_funcs += ";";
-            compiled_funcs += child.ctx_type + " " + child.ident;
-            Transpile(child.arg_nodes, _buildFile, compiled_funcs, true);
-            Transpile(child.body, _buildFile, compiled_funcs, true);
+            compiled_funcs += std::string(child.ctx_type) + " " + std::string(child.ident);
+            Transpile(_ctx, _ast, child.arg_nodes, _buildFile, compiled_funcs, true);
+            Transpile(_ctx, _ast, child.body, _buildFile, compiled_funcs, true);
+
+            // the function is complete, nothing edits it anymore
+            if (!onlyAppend && !_buildFile.empty() && compiled_funcs.size() >= CompiledOutput::SPILL_THRESHOLD)
+                output.spill(_buildFile, compiled_funcs);
+            continue;
+        }
+
+        if (child.type == FOR && !child.arg_nodes.empty()) {
+            _dest += rangeLoop(_ast, child);
+            continue;
+        }
+
+        if (child.type == FOR && !child.ident.empty()) {
+            _dest += "for (auto&& " + std::string(child.ident) + " : " + std::string(child.value) + ")";
             continue;
         }
 
         if (child.type == FOR || child.type == WHILE) {
-            _dest += std::string(child.type == FOR ? "for":"while") + " (" + child.value + ")";
+            _dest += std::string(child.type == FOR ? "for":"while") + " (" + std::string(child.value) + ")";
             continue;
         }
 
@@ -167,12 +395,12 @@ std::optional<std::unordered_map<std::string, std::string>> Transpile(
 
         if (child.type == KEYWORD) {
             if   (child.value == "break" || child.value == "continue")
-                { _dest += child.value + ";"; continue; }
+                { _dest += std::string(child.value) + ";"; continue; }
             else if (child.value == "true" || child.value == "false")
                 { _dest += child.value; SC_IF_IN_PRNS; continue;}
             else if (child.value == "importc")
                 { cimports += "#include "; is_include = true; continue;}
-            else{ _dest += child.value + " "; continue; }
+            else{ _dest += std::string(child.value) + " "; continue; }
         }
 
         if (child.type == IMPORT) {
@@ -181,14 +409,14 @@ std::optional<std::unordered_map<std::string, std::string>> Transpile(
 
         if (child.type == MACRO) {
             if (child.value.starts_with("typedef")) {
-                std::basic_string<char> typedefin = child.value.substr(7);
+                std::basic_string<char> typedefin(child.value.substr(7));
                 std::basic_string<char> f_type = splitStr(typedefin, ' ')[1];
                 typedefin.insert(child.value.find_first_of(f_type) + f_type.size() + 1, "=");
                 macros += "using " + typedefin + ";";
                 continue;
             }
 
-            macros += "#" + child.value + "\n";
+            macros += "#" + std::string(child.value) + "\n";
             continue;
         }
 
@@ -227,12 +455,12 @@ std::optional<std::unordered_map<std::string, std::string>> Transpile(
 //                read_ret_type = false;
 //                _dest.replace(_dest.find(last_func_ident) - 5, 4, child.value);
 //            }
-            if (type_registry.contains(child.value)) {_dest += child.value + " "; rd_type = true; continue; }
+            if (type_registry.contains(child.symbol)) {_dest += std::string(child.value) + " "; rd_type = true; continue; }
             if (rd_type) {
-                if (_dest == compiled_funcs)
-                    symbol_table[child.value] = "%" + last_func_ident;
+                if (&_dest == &compiled_funcs)
+                    symbol_table[child.symbol] = "%" + last_func_ident;
                 else
-                    symbol_table[child.value] = "$" + std::string("__main__");
+                    symbol_table[child.symbol] = "$" + std::string("__main__");
                 rd_type = false;
             }
             _dest += child.value;
@@ -261,7 +489,7 @@ std::optional<std::unordered_map<std::string, std::string>> Transpile(
             if (child.type == ELSE)
                 { if (_dest[_dest.size() - 1] == ';') _dest.erase(_dest.size() - 1); _dest += "else"; }
             else
-                _dest += std::string(child.type == IF ? "if" : child.type == ELIF ? "elif":"else") + " (" + child.value + ")"; // please forgive me
+                _dest += std::string(child.type == IF ? "if" : child.type == ELIF ? "elif":"else") + " (" + std::string(child.value) + ")"; // please forgive me
             continue;
         }
 
@@ -272,7 +500,7 @@ std::optional<std::unordered_map<std::string, std::string>> Transpile(
         }
 
         if (child.type == VAR) {
-            _dest += child.ctx_type + " " + child.ident;
+            _dest += std::string(child.ctx_type) + " " + std::string(child.ident);
             if (!child.initialized && !rd_function) _dest += ";";
             else _dest += "=";
             continue;
@@ -286,18 +514,8 @@ std::optional<std::unordered_map<std::string, std::string>> Transpile(
     if (returnSymbolTable)
         ret = symbol_table;
 
-    if (!onlyAppend) {
-        _dest.insert(bt_size, "\n" + macros + "\n");
-        bt_size = bt_size + macros.size();
-
-        _dest.insert(bt_size, compiled_funcs);
-        _dest.insert(0, cimports);
-
-        std::ofstream o_file_buf(_buildFile);
+    if (!onlyAppend)
         _dest += "}";
-        o_file_buf << _dest;
-        o_file_buf.close();
-    }
 
     return ret;
 }
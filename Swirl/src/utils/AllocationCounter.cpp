@@ -0,0 +1,14 @@
+#include <new>
+#include <cstdlib>
+
+#include <utils/TimeReport.h>
+
+void* operator new(std::size_t _size) {
+    countAllocation(_size);
+
+    if (void* ptr = std::malloc(_size ? _size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* _ptr) noexcept { std::free(_ptr); }
+void operator delete(void* _ptr, std::size_t) noexcept { std::free(_ptr); }
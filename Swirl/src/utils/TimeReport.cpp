@@ -0,0 +1,114 @@
+#include <atomic>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include <utils/TimeReport.h>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+static std::atomic<uint64_t> alloc_count{0};
+static std::atomic<uint64_t> alloc_bytes{0};
+
+void countAllocation(std::size_t _size) {
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    alloc_bytes.fetch_add(_size, std::memory_order_relaxed);
+}
+
+uint64_t allocationCount() { return alloc_count.load(std::memory_order_relaxed); }
+uint64_t allocatedBytes() { return alloc_bytes.load(std::memory_order_relaxed); }
+
+/** @brief the highest RSS of this process or of any of its waited-for children, in KiB */
+static long peakRss() {
+#if defined(_WIN32)
+    return 0;
+#else
+    rusage self{}, children{};
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
+    long peak = std::max(self.ru_maxrss, children.ru_maxrss);
+#if defined(__APPLE__)
+    peak /= 1024;  // bytes on macOS
+#endif
+    return peak;
+#endif
+}
+
+/** @brief the number of the calling thread in the trace */
+static unsigned threadIndex() {
+    static std::atomic<unsigned> next_index{1};
+    thread_local unsigned index = next_index.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+TimeReport::Scope::Scope(TimeReport* _report, std::string_view _name)
+        : m_Report(_report), m_Name(_name), m_Start(Clock::now()),
+          m_Allocations(allocationCount()), m_AllocBytes(allocatedBytes()) {}
+
+void TimeReport::Scope::end() {
+    if (!m_Report) return;
+
+    auto now = Clock::now();
+    std::lock_guard lock(m_Report->m_Mutex);
+    m_Report->m_Phases.push_back({
+            .name        = std::string(m_Name),
+            .start_us    = std::chrono::duration_cast<std::chrono::microseconds>(m_Start - m_Report->m_Start).count(),
+            .duration_us = std::chrono::duration_cast<std::chrono::microseconds>(now - m_Start).count(),
+            .allocations = allocationCount() - m_Allocations,
+            .alloc_bytes = allocatedBytes() - m_AllocBytes,
+            .peak_rss_kb = peakRss(),
+            .thread      = threadIndex()
+    });
+    m_Report = nullptr;
+}
+
+void TimeReport::print(std::ostream& _out) const {
+    char line[128];
+    PhaseRecord total{.name = "total"};
+
+    std::snprintf(line, sizeof(line), "%-18s %12s %12s %12s %14s\n", "phase", "wall (ms)", "allocs", "alloc (KiB)", "peak RSS (MiB)");
+    _out << line;
+
+    auto print_row = [&](const PhaseRecord& _phase) {
+        std::snprintf(line, sizeof(line), "%-18s %12.3f %12llu %12.1f %14.1f\n", _phase.name.c_str(),
+                      _phase.duration_us / 1000.0, static_cast<unsigned long long>(_phase.allocations),
+                      _phase.alloc_bytes / 1024.0, _phase.peak_rss_kb / 1024.0);
+        _out << line;
+    };
+
+    int64_t first_start = 0, last_end = 0;
+    for (std::size_t i = 0; i < m_Phases.size(); i++) {
+        const PhaseRecord& phase = m_Phases[i];
+        print_row(phase);
+        first_start = i ? std::min(first_start, phase.start_us) : phase.start_us;
+        last_end    = std::max(last_end, phase.start_us + phase.duration_us);
+        total.peak_rss_kb = std::max(total.peak_rss_kb, phase.peak_rss_kb);
+    }
+
+    total.duration_us = last_end - first_start;
+    total.allocations = allocationCount() - m_StartAllocations;
+    total.alloc_bytes = allocatedBytes() - m_StartAllocBytes;
+
+    print_row(total);
+}
+
+bool TimeReport::writeTrace(const std::string& _path) const {
+    std::ofstream trace_buf(_path);
+    if (!trace_buf) return false;
+
+    trace_buf << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (std::size_t i = 0; i < m_Phases.size(); i++) {
+        const PhaseRecord& phase = m_Phases[i];
+        trace_buf << (i ? ",\n" : "\n")
+                  << "{\"name\":\"" << phase.name << "\",\"cat\":\"swirl\",\"ph\":\"X\",\"pid\":1,\"tid\":" << phase.thread
+                  << ",\"ts\":" << phase.start_us << ",\"dur\":" << phase.duration_us
+                  << ",\"args\":{\"allocations\":" << phase.allocations << ",\"alloc_bytes\":" << phase.alloc_bytes
+                  << ",\"peak_rss_kb\":" << phase.peak_rss_kb << "}}";
+    }
+    trace_buf << "\n]}\n";
+
+    return static_cast<bool>(trace_buf);
+}
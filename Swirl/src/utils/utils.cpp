@@ -2,74 +2,233 @@
 #include <fstream>
 #include <algorithm>
 #include <vector>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <array>
+#include <cerrno>
 
-#include "swirl.typedefs/swirl_t.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
 
-#define LOG(x) if (_debug) std::cout << "[DEBUG] " << "[" << __builtin_FUNCTION() << "]\t" << x << std::endl;
+#include <utils/utils.h>
 
-struct F_IO_Object
-{
-    class R_ModeObject
-    {
-    private:
-        Swirl::string source;
+LineReader::LineReader(const std::string& _path, std::size_t _bufferSize)
+    : m_File(std::fopen(_path.c_str(), "rb")), m_Buffer(std::max<std::size_t>(_bufferSize, 16)) {
+    // the buffer above is the only one, stdio's would add a copy of every byte
+    if (m_File) std::setvbuf(m_File, nullptr, _IONBF, 0);
+}
 
-    public:
-        R_ModeObject(Swirl::string source) : source(source) {}
+LineReader::LineReader(LineReader&& _other) noexcept
+    : m_File(_other.m_File), m_Buffer(std::move(_other.m_Buffer)), m_Begin(_other.m_Begin), m_End(_other.m_End) {
+    _other.m_File = nullptr;
+}
 
-        Swirl::string read() { return source; }
-        std::vector<Swirl::string> readlines()
-        {
-            return source.split("\n");
+LineReader::~LineReader() {
+    if (m_File) std::fclose(m_File);
+}
+
+bool LineReader::next(std::string_view& _line) {
+    std::size_t scanned = m_Begin;
+    while (true) {
+        auto newline = static_cast<const char*>(std::memchr(m_Buffer.data() + scanned, '\n', m_End - scanned));
+        if (newline) {
+            std::size_t end = newline - m_Buffer.data();
+            _line = {m_Buffer.data() + m_Begin, end - m_Begin};
+            m_Begin = end + 1;
+            return true;
         }
-    };
 
-    class W_ModeObject
-    {
-    private:
-        std::string filePath;
-        std::ofstream w_buf;
+        // the rest of the buffer is part of a line that has not been read in full
+        if (!m_File || std::feof(m_File) || std::ferror(m_File)) {
+            if (m_Begin == m_End) return false;
+            _line = {m_Buffer.data() + m_Begin, m_End - m_Begin};
+            m_Begin = m_End;
+            return true;
+        }
 
-    public:
-        W_ModeObject(Swirl::string filePath) : filePath(filePath.__to_cpp_str__()) {}
+        std::memmove(m_Buffer.data(), m_Buffer.data() + m_Begin, m_End - m_Begin);
+        m_End -= m_Begin;
+        m_Begin = 0;
+        scanned = m_End;
+        if (m_End == m_Buffer.size()) m_Buffer.resize(m_Buffer.size() * 2);
 
-        void write(Swirl::string str, int streamCount = 0)
-        {
-            w_buf = std::ofstream(this->filePath);
-            w_buf.write(str.__to_cstr__(), streamCount);
-        }
+        m_End += std::fread(m_Buffer.data() + m_End, 1, m_Buffer.size() - m_End, m_File);
+    }
+}
 
-        void close() { w_buf.close(); }
-    };
+Swirl::string F_IO_Object::R_ModeObject::read() {
+    std::ifstream r_buf(this->filePath, std::ios::binary);
+    return std::string{std::istreambuf_iterator<char>(r_buf), {}};
+}
 
-    class DualModeObject
-    {
-    private:
-        std::string filePath;
-        std::ofstream w_buf;
+FileWriter::FileWriter(const std::string& _path, unsigned _flags, std::size_t _bufferSize) : m_Flags(_flags) {
+    // O_DIRECT needs block-aligned buffers and sizes, the capacity is rounded up to whole blocks
+    m_Capacity = (std::max<std::size_t>(_bufferSize, ALIGNMENT) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    m_Buffer = static_cast<char*>(::operator new(m_Capacity, std::align_val_t{ALIGNMENT}));
 
-    public:
-        DualModeObject(Swirl::string filePath) : filePath(filePath.__to_cpp_str__()) {}
+#ifndef _WIN32
+    int mode = O_WRONLY | O_CREAT | (_flags & APPEND ? O_APPEND : O_TRUNC);
+#ifdef O_DIRECT
+    if (_flags & DIRECT) m_Fd = ::open(_path.c_str(), mode | O_DIRECT, 0644);
+#endif
+    // appending from an unaligned end of file would make every O_DIRECT write fail
+    if (m_Fd != -1 && _flags & APPEND && ::lseek(m_Fd, 0, SEEK_END) % ALIGNMENT) {
+        ::close(m_Fd);
+        m_Fd = -1;
+    }
 
-        void write(Swirl::string str, int streamCount = 0)
-        {
-            w_buf = std::ofstream(this->filePath, std::ios_base::app);
-            w_buf.write(str.__to_cstr__(), streamCount);
-        }
+    // not every file system supports O_DIRECT (tmpfs doesn't), it is only a hint
+    if (m_Fd == -1) {
+        m_Flags &= ~DIRECT;
+        m_Fd = ::open(_path.c_str(), mode, 0644);
+    }
+#else
+    m_Flags &= ~DIRECT;
+    m_File = std::fopen(_path.c_str(), _flags & APPEND ? "ab" : "wb");
+    if (m_File) std::setvbuf(m_File, nullptr, _IONBF, 0);
+#endif
+}
 
-        Swirl::string read()
-        {
-            std::ifstream r_buf(this->filePath);
-            std::string ret;
-            std::string c_l;
-            while (std::getline(r_buf, c_l))
-                ret += c_l;
-            return {static_cast<const char*>(ret.c_str())};
+FileWriter::FileWriter(FileWriter&& _other) noexcept
+    : m_Fd(_other.m_Fd), m_File(_other.m_File), m_Flags(_other.m_Flags), m_Buffer(_other.m_Buffer),
+      m_Capacity(_other.m_Capacity), m_Size(_other.m_Size), m_Failed(_other.m_Failed) {
+    _other.m_Fd = -1;
+    _other.m_File = nullptr;
+    _other.m_Buffer = nullptr;
+    _other.m_Size = 0;
+}
+
+bool FileWriter::writeAll(std::string_view _first, std::string_view _second) {
+#ifndef _WIN32
+    std::array<iovec, 2> iov = {{
+            {const_cast<char*>(_first.data()), _first.size()},
+            {const_cast<char*>(_second.data()), _second.size()}
+    }};
+
+    // writev may stop short, resume from the first piece that wasn't fully written
+    iovec* cur = iov.data();
+    int    left = _second.empty() ? 1 : 2;
+    while (left > 0) {
+        ssize_t written = ::writev(m_Fd, cur, left);
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0) { m_Failed = true; return false; }
+
+        while (left > 0 && static_cast<std::size_t>(written) >= cur->iov_len) {
+            written -= static_cast<ssize_t>(cur->iov_len);
+            cur++; left--;
         }
+        if (left > 0) {
+            cur->iov_base = static_cast<char*>(cur->iov_base) + written;
+            cur->iov_len -= written;
+        }
+    }
+    return true;
+#else
+    if (std::fwrite(_first.data(), 1, _first.size(), m_File) != _first.size()
+        || std::fwrite(_second.data(), 1, _second.size(), m_File) != _second.size()) {
+        m_Failed = true;
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool FileWriter::drain(bool _all) {
+    std::size_t count = m_Size;
+    if (m_Flags & DIRECT && !_all) count -= count % ALIGNMENT;
+    if (!count) return true;
+
+#if !defined(_WIN32) && defined(O_DIRECT)
+    // the unaligned tail of the file can only be written with the page cache
+    if (m_Flags & DIRECT && count % ALIGNMENT) {
+        fcntl(m_Fd, F_SETFL, fcntl(m_Fd, F_GETFL) & ~O_DIRECT);
+        m_Flags &= ~DIRECT;
+    }
+#endif
+
+    if (!writeAll({m_Buffer, count})) return false;
+    std::memmove(m_Buffer, m_Buffer + count, m_Size - count);
+    m_Size -= count;
+    return true;
+}
+
+bool FileWriter::write(std::string_view _data) {
+    if (!isOpen()) return false;
+
+    if (m_Size + _data.size() <= m_Capacity) {
+        std::memcpy(m_Buffer + m_Size, _data.data(), _data.size());
+        m_Size += _data.size();
+        return true;
+    }
+
+    if (!(m_Flags & DIRECT)) {
+        // the buffer and the data that overflows it leave in one system call
+        bool ok = writeAll({m_Buffer, m_Size}, _data);
+        m_Size = 0;
+        return ok;
+    }
+
+    // with DIRECT everything goes through the aligned buffer, in whole blocks
+    while (!_data.empty()) {
+        std::size_t count = std::min(_data.size(), m_Capacity - m_Size);
+        std::memcpy(m_Buffer + m_Size, _data.data(), count);
+        m_Size += count;
+        _data.remove_prefix(count);
+        if (m_Size == m_Capacity && !drain(false)) return false;
+    }
+    return true;
+}
 
-        void close() { w_buf.close(); }
-    };
-};
+bool FileWriter::flush() {
+    if (!isOpen()) return false;
+    if (!drain(true)) return false;
+
+#ifndef _WIN32
+    if (m_Flags & SYNC && ::fsync(m_Fd) != 0) m_Failed = true;
+#else
+    if (std::fflush(m_File) != 0) m_Failed = true;
+#endif
+    return !m_Failed;
+}
+
+bool FileWriter::close() {
+    bool ok = isOpen() && flush();
+
+#ifndef _WIN32
+    if (m_Fd != -1 && ::close(m_Fd) != 0) ok = false;
+    m_Fd = -1;
+#else
+    if (m_File && std::fclose(m_File) != 0) ok = false;
+    m_File = nullptr;
+#endif
+
+    if (m_Buffer) ::operator delete(m_Buffer, std::align_val_t{ALIGNMENT});
+    m_Buffer = nullptr;
+    return ok;
+}
+
+bool F_IO_Object::W_ModeObject::write(const Swirl::string& str, int streamCount) {
+    std::string_view data = str;
+    if (streamCount > 0) data = data.substr(0, streamCount);
+    return w_buf.write(data);
+}
+
+bool F_IO_Object::DualModeObject::write(const Swirl::string& str, int streamCount) {
+    std::string_view data = str;
+    if (streamCount > 0) data = data.substr(0, streamCount);
+    return w_buf.write(data);
+}
+
+Swirl::string F_IO_Object::DualModeObject::read() {
+    // pending writes have to be on disk for the read to see them
+    w_buf.flush();
+    std::ifstream r_buf(this->filePath, std::ios::binary);
+    return std::string{std::istreambuf_iterator<char>(r_buf), {}};
+}
 
 #if defined(_WIN32)
 #define PATH_SEP "\\"
@@ -0,0 +1,610 @@
+/*
+Copyright (C) 2022 Swirl Organization
+
+This file is part of the Swirl programming language
+
+Swirl is free software: you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+Swirl is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with this program.
+If not, see https://www.gnu.org/licenses/.
+*/
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <functional>
+#include <string_view>
+#include <system_error>
+#include <condition_variable>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <linux/io_uring.h>
+#define SWIRL_IO_URING
+#endif
+
+#include "io.h"
+
+namespace IO
+{
+    bool FileStat::isDir() const { return (mode & S_IFMT) == S_IFDIR; }
+    bool FileStat::isFile() const { return (mode & S_IFMT) == S_IFREG; }
+
+    [[noreturn]] static void raise(int _errno, const std::string& _path)
+    {
+        throw std::system_error(_errno, std::generic_category(), _path);
+    }
+
+    /* The blocking versions of the operations, run by the worker pool. */
+
+#ifndef _WIN32
+    static Swirl::string readSync(const std::string& _path)
+    {
+        int fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) raise(errno, _path);
+
+        struct stat st{};
+        std::string data(::fstat(fd, &st) == 0 && st.st_size > 0 ? st.st_size : 1 << 16, '\0');
+        std::size_t done = 0;
+        while (true) {
+            ssize_t res = ::read(fd, data.data() + done, data.size() - done);
+            if (res < 0 && errno == EINTR) continue;
+            if (res < 0) { int err = errno; ::close(fd); raise(err, _path); }
+            if (res == 0) break;
+
+            done += res;
+            // files that don't report a size (procfs, pipes) are read until the end
+            if (done == data.size()) data.resize(data.size() * 2);
+        }
+
+        ::close(fd);
+        data.resize(done);
+        return data;
+    }
+
+    static std::size_t writeSync(const std::string& _path, std::string_view _data, bool _append)
+    {
+        int fd = ::open(_path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (_append ? O_APPEND : O_TRUNC), 0644);
+        if (fd == -1) raise(errno, _path);
+
+        std::size_t done = 0;
+        while (done < _data.size()) {
+            ssize_t res = ::write(fd, _data.data() + done, _data.size() - done);
+            if (res < 0 && errno == EINTR) continue;
+            if (res <= 0) { int err = res < 0 ? errno : EIO; ::close(fd); raise(err, _path); }
+            done += res;
+        }
+
+        if (::close(fd) != 0) raise(errno, _path);
+        return done;
+    }
+
+    static FileStat statSync(const std::string& _path)
+    {
+        struct stat st{};
+        if (::stat(_path.c_str(), &st) != 0) raise(errno, _path);
+
+#ifdef __linux__
+        std::int64_t mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#else
+        std::int64_t mtime = st.st_mtime * 1000000000LL;
+#endif
+        return {static_cast<std::uint64_t>(st.st_size), static_cast<std::uint32_t>(st.st_mode), mtime};
+    }
+#else
+    static Swirl::string readSync(const std::string& _path)
+    {
+        std::ifstream r_buf(_path, std::ios::binary);
+        if (!r_buf) raise(ENOENT, _path);
+        return std::string{std::istreambuf_iterator<char>(r_buf), {}};
+    }
+
+    static std::size_t writeSync(const std::string& _path, std::string_view _data, bool _append)
+    {
+        std::ofstream w_buf(_path, std::ios::binary | (_append ? std::ios::app : std::ios::trunc));
+        if (!w_buf.write(_data.data(), static_cast<std::streamsize>(_data.size()))) raise(EIO, _path);
+        return _data.size();
+    }
+
+    static FileStat statSync(const std::string& _path)
+    {
+        struct _stat64 st{};
+        if (::_stat64(_path.c_str(), &st) != 0) raise(errno, _path);
+        return {static_cast<std::uint64_t>(st.st_size), static_cast<std::uint32_t>(st.st_mode),
+                st.st_mtime * 1000000000LL};
+    }
+#endif
+
+    /* Runs posted jobs on a fixed set of threads, the jobs still queued at destruction are run first. */
+    class WorkerPool
+    {
+        std::vector<std::thread>          m_Workers;
+        std::deque<std::function<void()>> m_Queue;
+        std::mutex                        m_Mutex;
+        std::condition_variable           m_Wake;
+        bool                              m_Stop = false;
+
+    public:
+        explicit WorkerPool(unsigned _workers)
+        {
+            for (unsigned i = 0; i < _workers; i++)
+                m_Workers.emplace_back([this] {
+                    while (true) {
+                        std::unique_lock lock(m_Mutex);
+                        m_Wake.wait(lock, [this] { return m_Stop || !m_Queue.empty(); });
+                        if (m_Queue.empty()) return;
+
+                        std::function<void()> job = std::move(m_Queue.front());
+                        m_Queue.pop_front();
+                        lock.unlock();
+                        job();
+                    }
+                });
+        }
+
+        ~WorkerPool()
+        {
+            { std::lock_guard lock(m_Mutex); m_Stop = true; }
+            m_Wake.notify_all();
+            for (std::thread& worker : m_Workers) worker.join();
+        }
+
+        void post(std::function<void()> _job)
+        {
+            { std::lock_guard lock(m_Mutex); m_Queue.push_back(std::move(_job)); }
+            m_Wake.notify_one();
+        }
+
+        /** @brief runs `_fn` on the pool, its result or exception ends up in the future */
+        template <typename Fn>
+        auto submit(Fn _fn) -> std::future<decltype(_fn())>
+        {
+            auto task = std::make_shared<std::packaged_task<decltype(_fn())()>>(std::move(_fn));
+            auto ret = task->get_future();
+            post([task] { (*task)(); });
+            return ret;
+        }
+    };
+
+#ifdef SWIRL_IO_URING
+    /**
+     * @brief An operation in flight on the ring, as a chain of steps (open, read, close...)
+     *
+     * Only one step of an operation is queued at a time. prepare() describes the next step,
+     * advance() takes its result and tells whether the operation is over.
+     */
+    struct Op
+    {
+        std::string path;
+        int         fd = -1;
+
+        explicit Op(std::string _path) : path(std::move(_path)) {}
+        virtual ~Op() { if (fd != -1) ::close(fd); }
+
+        virtual void prepare(io_uring_sqe& _sqe) = 0;
+        virtual bool advance(int _res) = 0;
+
+        /** @brief the system_error for a failed step, `_res` is the negated errno */
+        std::exception_ptr error(int _res) const
+        {
+            return std::make_exception_ptr(std::system_error(-_res, std::generic_category(), path));
+        }
+
+        void prepareOpen(io_uring_sqe& _sqe, int _flags, unsigned _mode = 0) const
+        {
+            _sqe.opcode = IORING_OP_OPENAT;
+            _sqe.fd = AT_FDCWD;
+            _sqe.addr = reinterpret_cast<std::uintptr_t>(path.c_str());
+            _sqe.open_flags = _flags | O_CLOEXEC;
+            _sqe.len = _mode;
+        }
+
+        void prepareClose(io_uring_sqe& _sqe) const
+        {
+            _sqe.opcode = IORING_OP_CLOSE;
+            _sqe.fd = fd;
+        }
+    };
+
+    struct ReadOp : Op
+    {
+        enum { OPEN, STAT, READ, CLOSE } stage = OPEN;
+        std::string                      data;
+        std::size_t                      done  = 0;
+        bool                             sized = false;
+        struct statx                     stx{};
+        std::promise<Swirl::string>      promise;
+
+        using Op::Op;
+
+        void prepare(io_uring_sqe& _sqe) override
+        {
+            switch (stage) {
+                case OPEN: prepareOpen(_sqe, O_RDONLY); break;
+                case STAT:
+                    _sqe.opcode = IORING_OP_STATX;
+                    _sqe.fd = fd;
+                    _sqe.addr = reinterpret_cast<std::uintptr_t>("");
+                    _sqe.len = STATX_SIZE;
+                    _sqe.statx_flags = AT_EMPTY_PATH;
+                    _sqe.off = reinterpret_cast<std::uintptr_t>(&stx);
+                    break;
+                case READ:
+                    _sqe.opcode = IORING_OP_READ;
+                    _sqe.fd = fd;
+                    _sqe.addr = reinterpret_cast<std::uintptr_t>(data.data() + done);
+                    _sqe.len = static_cast<unsigned>(std::min<std::size_t>(data.size() - done, 1u << 30));
+                    _sqe.off = done;
+                    break;
+                case CLOSE: prepareClose(_sqe); break;
+            }
+        }
+
+        bool advance(int _res) override
+        {
+            if (_res < 0) { promise.set_exception(error(_res)); return true; }
+
+            switch (stage) {
+                case OPEN: fd = _res; stage = STAT; return false;
+                case STAT:
+                    // files that don't report a size (procfs, pipes) are read until the end
+                    sized = stx.stx_size > 0;
+                    data.resize(sized ? stx.stx_size : 1 << 16);
+                    stage = READ;
+                    return false;
+                case READ:
+                    done += _res;
+                    if (_res == 0 || (sized && done == data.size())) { data.resize(done); stage = CLOSE; }
+                    else if (done == data.size()) data.resize(data.size() * 2);
+                    return false;
+                case CLOSE:
+                    fd = -1;
+                    promise.set_value(Swirl::string(data));
+                    return true;
+            }
+            return true;
+        }
+    };
+
+    struct WriteOp : Op
+    {
+        enum { OPEN, WRITE, CLOSE } stage = OPEN;
+        std::string                 data;
+        std::size_t                 done = 0;
+        bool                        append;
+        std::promise<std::size_t>   promise;
+
+        WriteOp(std::string _path, std::string_view _data, bool _append)
+            : Op(std::move(_path)), data(_data), append(_append) {}
+
+        void prepare(io_uring_sqe& _sqe) override
+        {
+            switch (stage) {
+                case OPEN: prepareOpen(_sqe, O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644); break;
+                case WRITE:
+                    _sqe.opcode = IORING_OP_WRITE;
+                    _sqe.fd = fd;
+                    _sqe.addr = reinterpret_cast<std::uintptr_t>(data.data() + done);
+                    _sqe.len = static_cast<unsigned>(std::min<std::size_t>(data.size() - done, 1u << 30));
+                    // -1 writes at the file position, which O_APPEND keeps at the end
+                    _sqe.off = append ? static_cast<std::uint64_t>(-1) : done;
+                    break;
+                case CLOSE: prepareClose(_sqe); break;
+            }
+        }
+
+        bool advance(int _res) override
+        {
+            if (_res < 0) { promise.set_exception(error(_res)); return true; }
+
+            switch (stage) {
+                case OPEN:
+                    fd = _res;
+                    stage = data.empty() ? CLOSE : WRITE;
+                    return false;
+                case WRITE:
+                    // nothing written with bytes left would resubmit the same write forever
+                    if (_res == 0) { promise.set_exception(error(-EIO)); return true; }
+                    done += _res;
+                    if (done == data.size()) stage = CLOSE;
+                    return false;
+                case CLOSE:
+                    fd = -1;
+                    promise.set_value(done);
+                    return true;
+            }
+            return true;
+        }
+    };
+
+    struct StatOp : Op
+    {
+        struct statx           stx{};
+        std::promise<FileStat> promise;
+
+        using Op::Op;
+
+        void prepare(io_uring_sqe& _sqe) override
+        {
+            _sqe.opcode = IORING_OP_STATX;
+            _sqe.fd = AT_FDCWD;
+            _sqe.addr = reinterpret_cast<std::uintptr_t>(path.c_str());
+            _sqe.len = STATX_BASIC_STATS;
+            _sqe.off = reinterpret_cast<std::uintptr_t>(&stx);
+        }
+
+        bool advance(int _res) override
+        {
+            if (_res < 0) { promise.set_exception(error(_res)); return true; }
+            promise.set_value({stx.stx_size, stx.stx_mode,
+                               stx.stx_mtime.tv_sec * 1000000000LL + stx.stx_mtime.tv_nsec});
+            return true;
+        }
+    };
+
+    /**
+     * @brief An io_uring driven by its own thread
+     *
+     * post() hands an operation over to the thread and wakes it through an eventfd, whose read is
+     * always queued on the ring next to the operations. At most ENTRIES - 1 operations are in flight,
+     * which keeps the completion queue (twice as large) from overflowing; the rest wait in m_Incoming.
+     */
+    class Ring
+    {
+        static constexpr unsigned ENTRIES = 256;
+
+        int m_Fd      = -1;
+        int m_EventFd = -1;
+
+        void*        m_SqMap  = nullptr;
+        std::size_t  m_SqSize = 0;
+        void*        m_CqMap  = nullptr;
+        std::size_t  m_CqSize = 0;
+        io_uring_sqe* m_Sqes  = nullptr;
+
+        unsigned*     m_SqTail  = nullptr;
+        unsigned*     m_SqMask  = nullptr;
+        unsigned*     m_SqArray = nullptr;
+        unsigned*     m_CqHead  = nullptr;
+        unsigned*     m_CqTail  = nullptr;
+        unsigned*     m_CqMask  = nullptr;
+        io_uring_cqe* m_Cqes    = nullptr;
+
+        std::thread                     m_Thread;
+        std::mutex                      m_Mutex;
+        std::deque<std::unique_ptr<Op>> m_Incoming;
+        bool                            m_Stop = false;
+        std::uint64_t                   m_Wakeups = 0;
+
+        Ring() = default;
+
+        /** @brief true when the kernel knows every opcode the operations use */
+        bool supportsOps() const
+        {
+            constexpr unsigned count = 256;
+            std::vector<char> buf(sizeof(io_uring_probe) + count * sizeof(io_uring_probe_op));
+            auto probe = reinterpret_cast<io_uring_probe*>(buf.data());
+            if (syscall(__NR_io_uring_register, m_Fd, IORING_REGISTER_PROBE, probe, count) != 0) return false;
+
+            for (int op : {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_CLOSE})
+                if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+            return true;
+        }
+
+        void push(const io_uring_sqe& _sqe, unsigned& _toSubmit)
+        {
+            unsigned tail = *m_SqTail;
+            unsigned index = tail & *m_SqMask;
+            m_Sqes[index] = _sqe;
+            m_SqArray[index] = index;
+            std::atomic_ref<unsigned>(*m_SqTail).store(tail + 1, std::memory_order_release);
+            _toSubmit++;
+        }
+
+        void pushOp(Op* _op, unsigned& _toSubmit)
+        {
+            io_uring_sqe sqe{};
+            _op->prepare(sqe);
+            sqe.user_data = reinterpret_cast<std::uintptr_t>(_op);
+            push(sqe, _toSubmit);
+        }
+
+        void run()
+        {
+            unsigned in_flight = 0, to_submit = 0;
+            bool     wake_armed = false;
+
+            while (true) {
+                {
+                    std::lock_guard lock(m_Mutex);
+                    if (m_Stop && m_Incoming.empty() && !in_flight) return;
+                    while (!m_Incoming.empty() && in_flight < ENTRIES - 1) {
+                        pushOp(m_Incoming.front().release(), to_submit);
+                        m_Incoming.pop_front();
+                        in_flight++;
+                    }
+                }
+
+                if (!wake_armed) {
+                    io_uring_sqe sqe{};
+                    sqe.opcode = IORING_OP_READ;
+                    sqe.fd = m_EventFd;
+                    sqe.addr = reinterpret_cast<std::uintptr_t>(&m_Wakeups);
+                    sqe.len = sizeof(m_Wakeups);
+                    push(sqe, to_submit);
+                    wake_armed = true;
+                }
+
+                int res = static_cast<int>(syscall(__NR_io_uring_enter, m_Fd, to_submit, 1, IORING_ENTER_GETEVENTS,
+                                                   nullptr, 0));
+                if (res < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) std::abort();
+                if (res > 0) to_submit -= res;
+
+                unsigned head = *m_CqHead;
+                unsigned tail = std::atomic_ref<unsigned>(*m_CqTail).load(std::memory_order_acquire);
+                for (; head != tail; head++) {
+                    const io_uring_cqe& cqe = m_Cqes[head & *m_CqMask];
+                    auto op = reinterpret_cast<Op*>(cqe.user_data);
+
+                    if (!op) wake_armed = false;
+                    else if (op->advance(cqe.res)) { delete op; in_flight--; }
+                    else pushOp(op, to_submit);
+                }
+                std::atomic_ref<unsigned>(*m_CqHead).store(head, std::memory_order_release);
+            }
+        }
+
+    public:
+        /** @brief a running ring, nullptr if the kernel doesn't provide one this module can use */
+        static std::unique_ptr<Ring> create()
+        {
+            std::unique_ptr<Ring> ring(new Ring);
+            io_uring_params params{};
+            ring->m_Fd = static_cast<int>(syscall(__NR_io_uring_setup, ENTRIES, &params));
+            if (ring->m_Fd < 0 || !(params.features & IORING_FEAT_SINGLE_MMAP) || !ring->supportsOps()) return nullptr;
+
+            ring->m_SqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            ring->m_CqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            ring->m_SqSize = ring->m_CqSize = std::max(ring->m_SqSize, ring->m_CqSize);
+
+            void* rings = mmap(nullptr, ring->m_SqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                               ring->m_Fd, IORING_OFF_SQ_RING);
+            if (rings == MAP_FAILED) return nullptr;
+            ring->m_SqMap = ring->m_CqMap = rings;
+
+            void* sqes = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, ring->m_Fd, IORING_OFF_SQES);
+            if (sqes == MAP_FAILED) return nullptr;
+            ring->m_Sqes = static_cast<io_uring_sqe*>(sqes);
+
+            auto at = [rings](unsigned _offset) { return reinterpret_cast<unsigned*>(static_cast<char*>(rings) + _offset); };
+            ring->m_SqTail  = at(params.sq_off.tail);
+            ring->m_SqMask  = at(params.sq_off.ring_mask);
+            ring->m_SqArray = at(params.sq_off.array);
+            ring->m_CqHead  = at(params.cq_off.head);
+            ring->m_CqTail  = at(params.cq_off.tail);
+            ring->m_CqMask  = at(params.cq_off.ring_mask);
+            ring->m_Cqes    = reinterpret_cast<io_uring_cqe*>(static_cast<char*>(rings) + params.cq_off.cqes);
+
+            ring->m_EventFd = eventfd(0, EFD_CLOEXEC);
+            if (ring->m_EventFd == -1) return nullptr;
+
+            ring->m_Thread = std::thread(&Ring::run, ring.get());
+            return ring;
+        }
+
+        ~Ring()
+        {
+            if (m_Thread.joinable()) {
+                { std::lock_guard lock(m_Mutex); m_Stop = true; }
+                std::uint64_t one = 1;
+                (void) ::write(m_EventFd, &one, sizeof(one));
+                m_Thread.join();
+            }
+
+            if (m_Sqes) munmap(m_Sqes, ENTRIES * sizeof(io_uring_sqe));
+            if (m_SqMap) munmap(m_SqMap, m_SqSize);
+            if (m_EventFd != -1) ::close(m_EventFd);
+            if (m_Fd != -1) ::close(m_Fd);
+        }
+
+        template <typename Operation>
+        auto post(std::unique_ptr<Operation> _op)
+        {
+            auto ret = _op->promise.get_future();
+            { std::lock_guard lock(m_Mutex); m_Incoming.push_back(std::move(_op)); }
+
+            std::uint64_t one = 1;
+            (void) ::write(m_EventFd, &one, sizeof(one));
+            return ret;
+        }
+    };
+#endif
+
+    /* Whichever of the two backends is in use, picked on the first operation. */
+    struct Executor
+    {
+#ifdef SWIRL_IO_URING
+        std::unique_ptr<Ring> ring;
+#endif
+        std::unique_ptr<WorkerPool> pool;
+
+        Executor()
+        {
+            const char* forced = std::getenv("SWIRL_IO_BACKEND");
+            bool threads = forced && std::string_view(forced) == "threads";
+#ifdef SWIRL_IO_URING
+            if (!threads) ring = Ring::create();
+            if (ring) return;
+#endif
+            // the workers mostly wait on the disk, so there are more of them than cores
+            pool = std::make_unique<WorkerPool>(std::max(4u, std::thread::hardware_concurrency() * 2));
+        }
+    };
+
+    static Executor& executor()
+    {
+        static Executor ret;
+        return ret;
+    }
+
+    std::future<Swirl::string> read(const Swirl::string& _path)
+    {
+        Executor& exec = executor();
+#ifdef SWIRL_IO_URING
+        if (exec.ring) return exec.ring->post(std::make_unique<ReadOp>(_path.__to_cpp_str__()));
+#endif
+        return exec.pool->submit([path = _path.__to_cpp_str__()] { return readSync(path); });
+    }
+
+    std::future<std::size_t> write(const Swirl::string& _path, const Swirl::string& _data, bool _append)
+    {
+        Executor& exec = executor();
+#ifdef SWIRL_IO_URING
+        if (exec.ring) return exec.ring->post(std::make_unique<WriteOp>(_path.__to_cpp_str__(), _data.view(), _append));
+#endif
+        return exec.pool->submit([path = _path.__to_cpp_str__(), data = _data.__to_cpp_str__(), _append] {
+            return writeSync(path, data, _append);
+        });
+    }
+
+    std::future<FileStat> stat(const Swirl::string& _path)
+    {
+        Executor& exec = executor();
+#ifdef SWIRL_IO_URING
+        if (exec.ring) return exec.ring->post(std::make_unique<StatOp>(_path.__to_cpp_str__()));
+#endif
+        return exec.pool->submit([path = _path.__to_cpp_str__()] { return statSync(path); });
+    }
+
+    std::string backend()
+    {
+#ifdef SWIRL_IO_URING
+        if (executor().ring) return "io_uring";
+#endif
+        return "threads";
+    }
+}
@@ -0,0 +1,63 @@
+/* Asynchronous file IO, so that programs touching many files can overlap the system calls.
+
+Copyright (C) 2022 Swirl Organization
+
+This file is part of the Swirl programming language
+
+Swirl is free software: you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+Swirl is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with this program.
+If not, see https://www.gnu.org/licenses/.
+*/
+
+#ifndef Swirl_IO_H
+#define Swirl_IO_H
+
+#include <string>
+#include <future>
+#include <cstdint>
+
+#include "swirl.typedefs/swirl_t.h"
+
+/*
+ * Every call returns at once with a future of its result, a failed operation stores a
+ * std::system_error in the future. On Linux the operations are queued on an io_uring, where it is
+ * not available (older kernels, seccomp filters, other platforms) on a pool of worker threads.
+ * Setting SWIRL_IO_BACKEND=threads forces the pool.
+ */
+namespace IO
+{
+    struct FileStat
+    {
+        std::uint64_t size  = 0;
+        std::uint32_t mode  = 0;
+        std::int64_t  mtime = 0; // nanoseconds since the epoch
+
+        bool isDir() const;
+        bool isFile() const;
+    };
+
+    /** @brief the whole contents of the file at `_path` */
+    std::future<Swirl::string> read(const Swirl::string& _path);
+
+    /**
+     * @brief writes `_data` to the file at `_path`, which is created if needed
+     *
+     * @param _append add to the end of the file rather than replacing its contents
+     * @return the number of bytes written
+     */
+    std::future<std::size_t> write(const Swirl::string& _path, const Swirl::string& _data, bool _append = false);
+
+    std::future<FileStat> stat(const Swirl::string& _path);
+
+    /** @brief "io_uring" or "threads", whichever runs the operations */
+    std::string backend();
+}
+
+#endif